@@ -93,6 +93,7 @@ Plugin.authoring.includedirs =
 Plugin.authoring.files =
 {
     "**.cpp",
+    "../SoundEnginePlugin/FlexibleDelayLinesFXFilterDesign.cpp", -- Bakes the filter tables into the bank
     "**.h",
     "**.hpp",
     "**.c",
@@ -25,10 +25,19 @@ the specific language governing permissions and limitations under the License.
 *******************************************************************************/
 
 #include "FlexibleDelayLinesFX.h"
+#include "FlexibleDelayLinesFXCostModel.h"
+#include "FlexibleDelayLinesFXMemoryPool.h"
+#include "FlexibleDelayLinesFXFilterDesign.h"
 #include "../FlexibleDelayLinesConfig.h"
 
 #include <AK/AkWwiseSDKVersion.h>
 
+#include <AK/Tools/Common/AkLock.h>
+#include <AK/Tools/Common/AkAutoLock.h>
+
+#include <float.h>
+#include <stdio.h>
+
 AK::IAkPlugin* CreateFlexibleDelayLinesFX(AK::IAkPluginMemAlloc* in_pAllocator)
 {
     return AK_PLUGIN_NEW(in_pAllocator, FlexibleDelayLinesFX());
@@ -41,16 +50,75 @@ AK::IAkPluginParam* CreateFlexibleDelayLinesFXParams(AK::IAkPluginMemAlloc* in_p
 
 AK_IMPLEMENT_PLUGIN_FACTORY(FlexibleDelayLinesFX, AkPluginTypeEffect, FlexibleDelayLinesConfig::CompanyID, FlexibleDelayLinesConfig::PluginID)
 
+// Shared by every paged ring for pages the delay does not reach; only ever read
+static float s_silentPage[DELAY_PAGE_LEN] = {};
+static AkUInt8* const s_pSilentPage = (AkUInt8*)s_silentPage;
+
+// Minimum-phase oversampling filters depend only on the factor (2x to 16x): instances share each design
+static const int MINIMUM_PHASE_CACHE_SLOTS = 4;
+static const int MINIMUM_PHASE_CACHE_LEN = 8 * OVERSAMPLE_16X;
+static float s_minimumPhaseCache[MINIMUM_PHASE_CACHE_SLOTS][MINIMUM_PHASE_CACHE_LEN];
+static bool s_bMinimumPhaseCached[MINIMUM_PHASE_CACHE_SLOTS] = {};
+static CAkLock s_minimumPhaseCacheLock;
+
+// Resampler kernels depend on nothing but the constants: instances share one design.
+// Band b serves Doppler factors up to s_resamplerMaxFactors[b]. Its cutoff, in fractions of Nyquist,
+// keeps most of the transition band below Nyquist once raised by that factor.
+static const float s_resamplerMaxFactors[4] = { 1.02f, 1.3f, 1.7f, FLT_MAX };
+static const float s_resamplerCutoffs[4] = { 0.9f, 0.62f, 0.44f, 0.3f };
+static const float RESAMPLER_KAISER_BETA = 7.0f;
+float FlexibleDelayLinesFX::s_resamplerKernels[RESAMPLER_BANDS * RESAMPLER_BAND_LEN];
+bool FlexibleDelayLinesFX::s_bResamplerKernelsDesigned = false;
+static CAkLock s_resamplerKernelsLock;
+
+#ifdef FLEXIBLEDELAYLINES_SSE2
+// MXCSR flush-to-zero and denormals-are-zero. The feedback, crossover and half-band IIRs decay into
+// denormals once the input goes silent, and x86 takes a microcode assist on every one of them.
+static const unsigned int MXCSR_FLUSH_DENORMALS = 0x8040;
+#endif
+
+// FDN line lengths follow the logarithms of the first primes, so no two lines share a common period
+static const float s_fdnLinePrimes[16] = { 2.0f, 3.0f, 5.0f, 7.0f, 11.0f, 13.0f, 17.0f, 19.0f,
+                                           23.0f, 29.0f, 31.0f, 37.0f, 41.0f, 43.0f, 47.0f, 53.0f };
+
 FlexibleDelayLinesFX::FlexibleDelayLinesFX()
     : m_pParams(nullptr)
+    , m_uParamsSequence(1)
     , m_pAllocator(nullptr)
     , m_pContext(nullptr)
-    , m_pDelayLines(nullptr)
-    , m_uNumChannels(0)
+    , m_pObjects(nullptr)
+    , m_uNumObjects(0)
+    , m_uMaxObjects(0)
     , m_fSampleRate(48000.0f)
     , m_fSamplesPerMeter(0.0f)
+    , m_fLoopSampleRate(48000.0f)
+    , m_storageFormat(STORAGE_FLOAT32)
+    , m_storageBytesPerSample(DelayStorageFloat32::BYTES_PER_SAMPLE)
+    , m_delayMemoryMode(DELAY_MEMORY_CONTIGUOUS)
+    , m_virtualSnapshot(VIRTUAL_SNAPSHOT_OFF)
+    , m_oversampleFactor(OVERSAMPLE_NONE)
+    , m_bShortRing(false)
+    , m_bShortRingClampReported(false)
+    , m_bPoolShortfallReported(false)
+    , m_ringBytes(0)
+    , m_feedbackMatrix(FEEDBACK_MATRIX_NONE)
     , m_pFIRCoefficients(nullptr)
     , m_FIRLength(0)
+    , m_oversamplingLatencyPhase(0)
+    , m_bBandSplit(false)
+    , m_decimationFactor(DECIMATE_NONE)
+    , m_pDecimationFIR(nullptr)
+    , m_decimationFIRLength(0)
+    , m_pInterpolationPolyphase(nullptr)
+    , m_interpolationTapsPerPhase(0)
+    , m_halfbandNumStages(0)
+    , m_pResamplerKernels(nullptr)
+    , m_delayCurveNumPoints(0)
+    , m_delayCurveCursor(0)
+    , m_delayCurveTime(0.0)
+    , m_uDelayCurveVersion(0)
+    , m_delayCurveRTPCDelayTime(0.0f)
+    , m_delayCurveRTPCDistance(0.0f)
 {
 }
 
@@ -58,18 +126,21 @@ FlexibleDelayLinesFX::~FlexibleDelayLinesFX()
 {
 }
 
-void FlexibleDelayLinesFX::InitializePowerComplementaryTable()
+void FlexibleDelayLinesFX::InitializePowerComplementaryTable(const FlexibleDelayLinesFilterTables* in_pTables)
 {
-    float oneOverTwoNminusOne = 1.0f / (float)((m_powerCompTableSize - 1) << 1);
+    if (in_pTables)
+        memcpy(m_powerCompTable, in_pTables->powerComplementary, sizeof(m_powerCompTable));
+    else
+        DesignPowerComplementaryTable(m_powerCompTable, m_powerCompTableSize);
     
     for (int i = 0; i < m_powerCompTableSize; ++i)
     {
-        float val = sinf((float)i * PI * oneOverTwoNminusOne);
-        m_powerCompTable[i] = val * val;
+        m_crossfadeInTable[i] = sqrtf(m_powerCompTable[i]);
+        m_crossfadeOutTable[i] = sqrtf(1.0f - m_powerCompTable[i]);
     }
 }
 
-void FlexibleDelayLinesFX::InitializeFIRCoefficients(int oversampleFactor)
+void FlexibleDelayLinesFX::InitializeFIRCoefficients(int oversampleFactor, AkUInt32 filterPhase, const FlexibleDelayLinesFilterTables* in_pTables)
 {
     if (oversampleFactor <= 1)
         return;
@@ -83,36 +154,161 @@ void FlexibleDelayLinesFX::InitializeFIRCoefficients(int oversampleFactor)
         return;
     }
     
-    float cutoff = 1.0f / (float)oversampleFactor;
-    int center = m_FIRLength / 2;
+    if (in_pTables && in_pTables->uFIRLength == (AkUInt32)m_FIRLength)
+    {
+        memcpy(m_pFIRCoefficients, in_pTables->fir, sizeof(float) * m_FIRLength);
+        return;
+    }
+    
+    // Interpolation filter at the oversampled rate: pass the original band, reject its images
+    float cutoff = 0.5f / (float)oversampleFactor;
+    DesignLowpassFIR(m_pFIRCoefficients, m_FIRLength, cutoff);
+    
+    if (filterPhase != FILTER_PHASE_MINIMUM)
+        return;
+    
+    int slot = -1;
+    for (int i = 0; i < MINIMUM_PHASE_CACHE_SLOTS; ++i)
+    {
+        if ((2 << i) == oversampleFactor)
+            slot = i;
+    }
+    
+    if (slot < 0)
+    {
+        // Not a cached factor: design in place, keeping the linear-phase filter if that fails
+        DesignMinimumPhaseFIR(m_pFIRCoefficients, m_pFIRCoefficients, m_FIRLength, m_pAllocator);
+        return;
+    }
+    
+    AkAutoLock<CAkLock> lock(s_minimumPhaseCacheLock);
+    if (!s_bMinimumPhaseCached[slot])
+    {
+        if (!DesignMinimumPhaseFIR(m_pFIRCoefficients, s_minimumPhaseCache[slot], m_FIRLength, m_pAllocator))
+            return;
+        s_bMinimumPhaseCached[slot] = true;
+    }
     
-    for (int i =0; i < m_FIRLength; ++i)
+    memcpy(m_pFIRCoefficients, s_minimumPhaseCache[slot], sizeof(float) * m_FIRLength);
+}
+
+bool FlexibleDelayLinesFX::InitializeHalfbandCoefficients(int oversampleFactor, const FlexibleDelayLinesFilterTables* in_pTables)
+{
+    if (in_pTables && in_pTables->uHalfbandNumStages > 0 && (1 << in_pTables->uHalfbandNumStages) == oversampleFactor)
     {
-        int n = i - center;
-        if (n == 0)
+        m_halfbandNumStages = (int)in_pTables->uHalfbandNumStages;
+        for (int stage = 0; stage < m_halfbandNumStages; ++stage)
         {
-            m_pFIRCoefficients[i] = 2.0f * cutoff;
+            m_halfbandNumCoefs[stage] = (int)in_pTables->halfbandNumCoefs[stage];
+            memcpy(m_halfbandCoefs[stage], in_pTables->halfbandCoefs[stage], sizeof(float) * m_halfbandNumCoefs[stage]);
         }
-        else
+        return true;
+    }
+    
+    m_halfbandNumStages = DesignHalfbandCascade(oversampleFactor, m_halfbandNumCoefs, m_halfbandCoefs);
+    return m_halfbandNumStages > 0;
+}
+
+void FlexibleDelayLinesFX::InitializeResamplerKernels()
+{
+    AkAutoLock<CAkLock> lock(s_resamplerKernelsLock);
+    if (!s_bResamplerKernelsDesigned)
+    {
+        for (int band = 0; band < RESAMPLER_BANDS; ++band)
         {
-            float sinc = sinf(2.0f * PI * cutoff * (float)n) / (PI * (float)n);
-            
-            float window = 0.42f - 0.5f * cosf(2.0f * PI * (float)i / (float)(m_FIRLength - 1))
-                         + 0.08f * cosf(4.0f * PI * (float)i / (float)(m_FIRLength - 1));
-            
-            m_pFIRCoefficients[i] = sinc * window;
+            DesignResamplerKernels(s_resamplerKernels + band * RESAMPLER_BAND_LEN, RESAMPLER_TAPS, RESAMPLER_PHASES,
+                s_resamplerCutoffs[band], RESAMPLER_KAISER_BETA);
         }
+        s_bResamplerKernelsDesigned = true;
     }
     
-    float sum = 0.0f;
-    for (int i = 0; i < m_FIRLength; ++i)
-        sum += m_pFIRCoefficients[i];
+    m_pResamplerKernels = s_resamplerKernels;
+}
+
+float FlexibleDelayLinesFX::GetHalfbandLatency(int oversampleFactor) const
+{
+    // At DC each allpass section delays by (1 - a) / (1 + a) samples of its path's rate, which is
+    // half the stage's rate; the stage averages its two paths, one of which is a sample late
+    float latency = 0.0f;
+    for (int stage = 0; stage < m_halfbandNumStages; ++stage)
+    {
+        float stageDelay = 0.5f;
+        for (int i = 0; i < m_halfbandNumCoefs[stage]; ++i)
+            stageDelay += (1.0f - m_halfbandCoefs[stage][i]) / (1.0f + m_halfbandCoefs[stage][i]);
+        
+        // Once on the way up and once on the way down, scaled to the oversampled rate
+        latency += 2.0f * stageDelay * (float)(oversampleFactor >> (stage + 1));
+    }
+    return latency;
+}
+
+void FlexibleDelayLinesFX::InitializeCrossover(float crossoverFrequency)
+{
+    const float w0 = 2.0f * PI * crossoverFrequency / m_fSampleRate;
+    const float cosW0 = cosf(w0);
+    const float alpha = sinf(w0) * 0.70710678f;   // Q = 1/sqrt(2)
+    const float invA0 = 1.0f / (1.0f + alpha);
+    
+    m_crossoverCoefs[0] = 0.5f * (1.0f - cosW0) * invA0;
+    m_crossoverCoefs[1] = (1.0f - cosW0) * invA0;
+    m_crossoverCoefs[2] = m_crossoverCoefs[0];
+    m_crossoverCoefs[3] = -2.0f * cosW0 * invA0;
+    m_crossoverCoefs[4] = (1.0f - alpha) * invA0;
+}
+
+bool FlexibleDelayLinesFX::InitializeDecimationFilters(int decimationFactor, const FlexibleDelayLinesFilterTables* in_pTables)
+{
+    if (decimationFactor <= 1)
+        return true;
+    
+    // Odd length keeps the filter symmetric around a whole sample
+    m_decimationFIRLength = 16 * decimationFactor + 1;
+    m_interpolationTapsPerPhase = (m_decimationFIRLength + decimationFactor - 1) / decimationFactor;
+    
+    m_pDecimationFIR = (float*)AK_PLUGIN_ALLOC(m_pAllocator, sizeof(float) * m_decimationFIRLength);
+    m_pInterpolationPolyphase = (float*)AK_PLUGIN_ALLOC(m_pAllocator,
+        sizeof(float) * m_interpolationTapsPerPhase * decimationFactor);
+    if (!m_pDecimationFIR || !m_pInterpolationPolyphase)
+        return false;
     
-    if (sum > 0.0f)
+    // Just under the reduced Nyquist, so that little of the transition band folds back into what is kept
+    if (in_pTables && in_pTables->uDecimationFIRLength == (AkUInt32)m_decimationFIRLength)
+        memcpy(m_pDecimationFIR, in_pTables->decimationFIR, sizeof(float) * m_decimationFIRLength);
+    else
+        DesignLowpassFIR(m_pDecimationFIR, m_decimationFIRLength, 0.45f / (float)decimationFactor);
+    
+    // Interpolating from the zero-stuffed signal only ever touches every decimationFactor-th tap;
+    // the factor restores the energy lost to the zeros
+    for (int phase = 0; phase < decimationFactor; ++phase)
     {
-        for (int i = 0; i < m_FIRLength; ++i)
-            m_pFIRCoefficients[i] /= sum;
+        for (int tap = 0; tap < m_interpolationTapsPerPhase; ++tap)
+        {
+            int index = phase + tap * decimationFactor;
+            m_pInterpolationPolyphase[phase * m_interpolationTapsPerPhase + tap] = index < m_decimationFIRLength
+                ? m_pDecimationFIR[index] * (float)decimationFactor
+                : 0.0f;
+        }
     }
+    
+    return true;
+}
+
+template<typename Storage, typename Ring>
+void FlexibleDelayLinesFX::InitializeMixKernels()
+{
+    MixKernels& wetDry = m_mixKernels[MIX_WET_DRY];
+    wetDry.oversampled = &FlexibleDelayLinesFX::ProcessOversampled<Storage, false>;
+    wetDry.standard = &FlexibleDelayLinesFX::ProcessStandard<Ring, false>;
+    wetDry.decimated = &FlexibleDelayLinesFX::ProcessDecimated<false>;
+    wetDry.fdn = &FlexibleDelayLinesFX::ProcessFDN<Ring, false>;
+    
+    MixKernels& wetOnly = m_mixKernels[MIX_WET_ONLY];
+    wetOnly.oversampled = &FlexibleDelayLinesFX::ProcessOversampled<Storage, true>;
+    wetOnly.standard = &FlexibleDelayLinesFX::ProcessStandard<Ring, true>;
+    wetOnly.decimated = &FlexibleDelayLinesFX::ProcessDecimated<true>;
+    wetOnly.fdn = &FlexibleDelayLinesFX::ProcessFDN<Ring, true>;
+    
+    m_pMixKernels = &m_mixKernels[MIX_WET_DRY];
 }
 
 AKRESULT FlexibleDelayLinesFX::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkEffectPluginContext* in_pContext, AK::IAkPluginParam* in_pParams, AkAudioFormat& in_rFormat)
@@ -121,20 +317,155 @@ AKRESULT FlexibleDelayLinesFX::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IA
     m_pAllocator = in_pAllocator;
     m_pContext = in_pContext;
     
-    m_uNumChannels = in_rFormat.GetNumChannels();
+    FlexibleDelayLinesFXMemoryPool::Get().AddUser(in_pAllocator);
+    
     m_fSampleRate = (float)in_rFormat.uSampleRate;
     m_fSamplesPerMeter = m_fSampleRate / SPEED_OF_SOUND;
     
-    InitializePowerComplementaryTable();
+    // Unlike Execute, Init has no previous copy to fall back on. It gives a publish in progress a
+    // bounded number of reads, then takes the published copy as is; the first Execute replaces it.
+    int round = 0;
+    while (!m_pParams->ReadSnapshot(m_params, m_uParamsSequence, PARAMS_SNAPSHOT_MAX_ATTEMPTS))
+    {
+        if (++round >= PARAMS_SNAPSHOT_INIT_ROUNDS)
+        {
+            m_pParams->ReadSnapshotUnchecked(m_params, m_uParamsSequence);
+            break;
+        }
+    }
+    
+    // Same fallbacks as the authoring cost estimate
+    const FlexibleDelayLinesEffectiveSettings settings = ResolveEffectiveSettings(m_params.NonRTPC, m_fSampleRate);
+    
+    m_storageFormat = settings.storageFormat;
+    m_storageBytesPerSample = GetDelayStorageBytesPerSample(m_storageFormat);
+    m_delayMemoryMode = settings.delayMemoryMode;
+    const bool bPagedMemory = m_delayMemoryMode == DELAY_MEMORY_PAGED;
+    const bool bPooledMemory = m_delayMemoryMode == DELAY_MEMORY_POOLED;
+    m_bShortRing = settings.bShortRing;
+    m_bShortRingClampReported = false;
+    m_bPoolShortfallReported = false;
+    m_ringBytes = m_bShortRing ? GetShortRingBytes(m_storageFormat) : GetDelayRingBytes(m_storageFormat, OVERSAMPLE_NONE);
+    
+    switch (m_storageFormat)
+    {
+    case STORAGE_HALF:
+        if (bPagedMemory)
+            InitializeMixKernels<DelayStorageHalf, PagedRing<DelayStorageHalf> >();
+        else if (m_bShortRing)
+            InitializeMixKernels<DelayStorageHalf, ContiguousRing<DelayStorageHalf, SHORT_BUFFER_LEN> >();
+        else if (bPooledMemory)
+            InitializeMixKernels<DelayStorageHalf, PooledRing<DelayStorageHalf> >();
+        else
+            InitializeMixKernels<DelayStorageHalf, ContiguousRing<DelayStorageHalf> >();
+        m_encodeSnapshotFunction = bPagedMemory
+            ? &FlexibleDelayLinesFX::EncodeSnapshot<PagedRing<DelayStorageHalf> >
+            : &FlexibleDelayLinesFX::EncodeSnapshot<PooledRing<DelayStorageHalf> >;
+        m_decodeSnapshotFunction = bPagedMemory
+            ? &FlexibleDelayLinesFX::DecodeSnapshot<PagedRing<DelayStorageHalf> >
+            : &FlexibleDelayLinesFX::DecodeSnapshot<PooledRing<DelayStorageHalf> >;
+        break;
+    case STORAGE_INT16:
+        if (bPagedMemory)
+            InitializeMixKernels<DelayStorageInt16, PagedRing<DelayStorageInt16> >();
+        else if (m_bShortRing)
+            InitializeMixKernels<DelayStorageInt16, ContiguousRing<DelayStorageInt16, SHORT_BUFFER_LEN> >();
+        else if (bPooledMemory)
+            InitializeMixKernels<DelayStorageInt16, PooledRing<DelayStorageInt16> >();
+        else
+            InitializeMixKernels<DelayStorageInt16, ContiguousRing<DelayStorageInt16> >();
+        m_encodeSnapshotFunction = bPagedMemory
+            ? &FlexibleDelayLinesFX::EncodeSnapshot<PagedRing<DelayStorageInt16> >
+            : &FlexibleDelayLinesFX::EncodeSnapshot<PooledRing<DelayStorageInt16> >;
+        m_decodeSnapshotFunction = bPagedMemory
+            ? &FlexibleDelayLinesFX::DecodeSnapshot<PagedRing<DelayStorageInt16> >
+            : &FlexibleDelayLinesFX::DecodeSnapshot<PooledRing<DelayStorageInt16> >;
+        break;
+    case STORAGE_PACKED24:
+        if (bPagedMemory)
+            InitializeMixKernels<DelayStoragePacked24, PagedRing<DelayStoragePacked24> >();
+        else if (m_bShortRing)
+            InitializeMixKernels<DelayStoragePacked24, ContiguousRing<DelayStoragePacked24, SHORT_BUFFER_LEN> >();
+        else if (bPooledMemory)
+            InitializeMixKernels<DelayStoragePacked24, PooledRing<DelayStoragePacked24> >();
+        else
+            InitializeMixKernels<DelayStoragePacked24, ContiguousRing<DelayStoragePacked24> >();
+        m_encodeSnapshotFunction = bPagedMemory
+            ? &FlexibleDelayLinesFX::EncodeSnapshot<PagedRing<DelayStoragePacked24> >
+            : &FlexibleDelayLinesFX::EncodeSnapshot<PooledRing<DelayStoragePacked24> >;
+        m_decodeSnapshotFunction = bPagedMemory
+            ? &FlexibleDelayLinesFX::DecodeSnapshot<PagedRing<DelayStoragePacked24> >
+            : &FlexibleDelayLinesFX::DecodeSnapshot<PooledRing<DelayStoragePacked24> >;
+        break;
+    case STORAGE_FLOAT32:
+    default:
+        if (bPagedMemory)
+            InitializeMixKernels<DelayStorageFloat32, PagedRing<DelayStorageFloat32> >();
+        else if (m_bShortRing)
+            InitializeMixKernels<DelayStorageFloat32, ContiguousRing<DelayStorageFloat32, SHORT_BUFFER_LEN> >();
+        else if (bPooledMemory)
+            InitializeMixKernels<DelayStorageFloat32, PooledRing<DelayStorageFloat32> >();
+        else
+            InitializeMixKernels<DelayStorageFloat32, ContiguousRing<DelayStorageFloat32> >();
+        m_encodeSnapshotFunction = bPagedMemory
+            ? &FlexibleDelayLinesFX::EncodeSnapshot<PagedRing<DelayStorageFloat32> >
+            : &FlexibleDelayLinesFX::EncodeSnapshot<PooledRing<DelayStorageFloat32> >;
+        m_decodeSnapshotFunction = bPagedMemory
+            ? &FlexibleDelayLinesFX::DecodeSnapshot<PagedRing<DelayStorageFloat32> >
+            : &FlexibleDelayLinesFX::DecodeSnapshot<PooledRing<DelayStorageFloat32> >;
+        break;
+    }
+    
+    // Tables baked into the bank for exactly these settings spare the design below
+    const FlexibleDelayLinesFilterTables* pTables = nullptr;
+    if (m_pParams->bHasFilterTables
+        && m_pParams->FilterTables.uOversampleFactor == (AkUInt32)settings.oversampleFactor
+        && m_pParams->FilterTables.uUpsamplingMethod == settings.upsamplingMethod
+        && m_pParams->FilterTables.uFilterPhase == m_params.NonRTPC.filterPhase
+        && m_pParams->FilterTables.uDecimationFactor == (AkUInt32)settings.decimationFactor)
+        pTables = &m_pParams->FilterTables;
+    
+    InitializePowerComplementaryTable(pTables);
+    
+    if (settings.interpolationType == INTERP_RESAMPLER)
+        InitializeResamplerKernels();
+    
+    m_feedbackMatrix = settings.feedbackMatrix;
+    
+    for (int line = 0; line < FDN_MAX_LINES; ++line)
+        m_fdnLineSpread[line] = logf(s_fdnLinePrimes[line] / s_fdnLinePrimes[0])
+            / logf(s_fdnLinePrimes[FDN_MAX_LINES - 1] / s_fdnLinePrimes[0]);
+    
+    m_decimationFactor = settings.decimationFactor;
+    if (!InitializeDecimationFilters(m_decimationFactor, pTables))
+        return AK_InsufficientMemory;
     
-    int oversampleFactor = m_pParams->NonRTPC.oversamplingFactor;
-    InitializeFIRCoefficients(oversampleFactor);
+    m_oversampleFactor = settings.oversampleFactor;
+    const int oversampleFactor = m_oversampleFactor;
+    m_virtualSnapshot = settings.virtualSnapshot;
     
     // Stocker le function pointer selon le choix
-    switch (m_pParams->NonRTPC.upsamplingMethod)
+    float oversamplingLatency = 0.0f;
+    m_downsampleFunction = &FlexibleDelayLinesFX::DropSampleDownsample;
+    switch (m_params.NonRTPC.upsamplingMethod)
     {
+    case UPSAMPLE_IIR_HALFBAND:
+        if (InitializeHalfbandCoefficients(oversampleFactor, pTables))
+        {
+            m_upsampleFunction = &FlexibleDelayLinesFX::HalfbandUpsample;
+            m_downsampleFunction = &FlexibleDelayLinesFX::HalfbandDownsample;
+            oversamplingLatency = GetHalfbandLatency(oversampleFactor);
+        }
+        else
+        {
+            m_upsampleFunction = &FlexibleDelayLinesFX::LinearUpsample;
+        }
+        break;
     case UPSAMPLE_POLYPHASE:
+        InitializeFIRCoefficients(oversampleFactor, m_params.NonRTPC.filterPhase, pTables);
         m_upsampleFunction = &FlexibleDelayLinesFX::PolyphaseUpsample;
+        if (m_pFIRCoefficients != nullptr)
+            oversamplingLatency = GetFIRGroupDelay(m_pFIRCoefficients, m_FIRLength);
         break;
     case UPSAMPLE_LINEAR:
         m_upsampleFunction = &FlexibleDelayLinesFX::LinearUpsample;
@@ -146,89 +477,424 @@ AKRESULT FlexibleDelayLinesFX::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IA
         m_upsampleFunction = &FlexibleDelayLinesFX::LinearUpsample;
     }
     
+    m_oversamplingLatencyPhase = (AkInt64)((double)oversamplingLatency * (double)DELAY_PHASE_ONE);
+    
+    m_bBandSplit = settings.bandSplitCrossover > 0;
+    if (m_bBandSplit)
+        InitializeCrossover((float)settings.bandSplitCrossover);
+    
+    m_fLoopSampleRate = oversampleFactor > OVERSAMPLE_NONE
+        ? m_fSampleRate * (float)oversampleFactor
+        : m_fSampleRate / (float)m_decimationFactor;
+    m_params.changes.SetAllParamChanges();
+    UpdateParamBlockParams();
+    
+    // Set up the first object for the bus format, so a bus without audio objects never allocates in Execute
+    m_pObjects = (DelayLineObject*)AK_PLUGIN_ALLOC(in_pAllocator, sizeof(DelayLineObject) * INITIAL_OBJECT_CAPACITY);
+    if (m_pObjects == nullptr)
+        return AK_InsufficientMemory;
+    m_uMaxObjects = INITIAL_OBJECT_CAPACITY;
+    
+    if (AcquireObject(AK_INVALID_AUDIO_OBJECT_ID, in_rFormat.GetNumChannels()) == nullptr)
+        return AK_InsufficientMemory;
+
+    return AK_Success;
+}
+
+AKRESULT FlexibleDelayLinesFX::AllocateDelayLines(DelayLineObject& object, AkUInt32 uNumChannels)
+{
+    const bool bPagedMemory = m_delayMemoryMode == DELAY_MEMORY_PAGED;
+    const int oversampleFactor = m_oversampleFactor;
+    
+    // Contiguous rings live as long as the object; the other modes wait for signal
+    object.pDelayLines = nullptr;
+    object.uNumChannels = 0;
+    object.bDelayMemoryActive = m_delayMemoryMode == DELAY_MEMORY_CONTIGUOUS;
+    object.uQuietFrames = 0;
+    object.pSnapshot = nullptr;
+    object.uSnapshotFrames = 0;
+    object.bSnapshotHeld = false;
+    object.uReservedBlocks = 0;
+    object.uReservedOversampledBlocks = 0;
+    
     // Allocate delay line array
-    m_pDelayLines = (DelayLineChannel*)AK_PLUGIN_ALLOC(in_pAllocator, sizeof(DelayLineChannel) * m_uNumChannels);
-    if (m_pDelayLines == nullptr)
+    object.pDelayLines = (DelayLineChannel*)AK_PLUGIN_ALLOC(m_pAllocator, sizeof(DelayLineChannel) * uNumChannels);
+    if (object.pDelayLines == nullptr)
         return AK_InsufficientMemory;
+    object.uNumChannels = uNumChannels;
+    
+    DelayLineChannel* pDelayLines = object.pDelayLines;
     
-    // Initialize each channel's delay line
-    for (AkUInt32 i = 0; i < m_uNumChannels; ++i)
+    // Initialize every channel first so FreeDelayLines can clean up after a partial allocation
+    for (AkUInt32 i = 0; i < uNumChannels; ++i)
     {
-        m_pDelayLines[i].buffer = nullptr;
-        m_pDelayLines[i].oversampledBuffer = nullptr;
-        m_pDelayLines[i].writePos = 0;
-        m_pDelayLines[i].lastDelayTime = 0.0f;
-        m_pDelayLines[i].oversampleFactor = oversampleFactor;
-        m_pDelayLines[i].effectiveBufferSize = MAX_BUFFER_LEN * oversampleFactor;
+        pDelayLines[i].buffer = nullptr;
+        pDelayLines[i].oversampledBuffer = nullptr;
+        pDelayLines[i].pages = nullptr;
+        pDelayLines[i].tempUpsampledInput = nullptr;
+        pDelayLines[i].tempDelayedOutput = nullptr;
+        pDelayLines[i].decimationHistory = nullptr;
+        pDelayLines[i].interpolationHistory = nullptr;
+        pDelayLines[i].halfbandState = nullptr;
+        pDelayLines[i].upsampleHistory = nullptr;
+        pDelayLines[i].upsamplePos = 0;
+        pDelayLines[i].decimationPos = 0;
+        pDelayLines[i].interpolationPos = 0;
+        pDelayLines[i].decimationPhase = 0;
+        pDelayLines[i].writePos = 0;
+        pDelayLines[i].firstWritePos = -1;
+        pDelayLines[i].restorePos = 0;
+        pDelayLines[i].numRestoreFrames = 0;
+        pDelayLines[i].delayPhase = 0;
+        pDelayLines[i].lastDelayTime = 0.0f;
+        pDelayLines[i].oversampleFactor = oversampleFactor;
+        pDelayLines[i].effectiveBufferSize = bPagedMemory ? PAGED_BUFFER_LEN
+            : (m_bShortRing ? SHORT_BUFFER_LEN : MAX_BUFFER_LEN * oversampleFactor);
+        pDelayLines[i].tailPage = 0;
+        pDelayLines[i].numCommittedPages = 0;
+        pDelayLines[i].dampingLowpassState = 0.0f;
+        pDelayLines[i].dampingHighpassState = 0.0f;
+        pDelayLines[i].dcBlockerInput = 0.0f;
+        pDelayLines[i].dcBlockerOutput = 0.0f;
+        memset(pDelayLines[i].crossoverState, 0, sizeof(pDelayLines[i].crossoverState));
+        memset(pDelayLines[i].lowBandFilterState, 0, sizeof(pDelayLines[i].lowBandFilterState));
+        pDelayLines[i].airAbsorptionState = 0.0f;
+        pDelayLines[i].distanceGain = 1.0f;
+        pDelayLines[i].crossfadeFrames = 0;
+    }
+    
+    // Allocate each channel's delay line
+    for (AkUInt32 i = 0; i < uNumChannels; ++i)
+    {
+        if (m_decimationFactor > DECIMATE_NONE)
+        {
+            pDelayLines[i].decimationHistory = (float*)AK_PLUGIN_ALLOC(m_pAllocator,
+                sizeof(float) * DECIMATION_HISTORY_LEN * 2);
+            pDelayLines[i].interpolationHistory = (float*)AK_PLUGIN_ALLOC(m_pAllocator,
+                sizeof(float) * INTERPOLATION_HISTORY_LEN * 2);
+            
+            if (!pDelayLines[i].decimationHistory || !pDelayLines[i].interpolationHistory)
+                return AK_InsufficientMemory;
+            
+            memset(pDelayLines[i].decimationHistory, 0, sizeof(float) * DECIMATION_HISTORY_LEN * 2);
+            memset(pDelayLines[i].interpolationHistory, 0, sizeof(float) * INTERPOLATION_HISTORY_LEN * 2);
+        }
         
-        m_pDelayLines[i].buffer = (float*)AK_PLUGIN_ALLOC(in_pAllocator, sizeof(float) * MAX_BUFFER_LEN);
-        if (m_pDelayLines[i].buffer == nullptr)
-            return AK_InsufficientMemory;
+        if (bPagedMemory)
+        {
+            // Only the page table is allocated up front; pages are committed as the delay needs them
+            pDelayLines[i].pages = (AkUInt8**)AK_PLUGIN_ALLOC(m_pAllocator, sizeof(AkUInt8*) * DELAY_PAGE_COUNT);
+            if (pDelayLines[i].pages == nullptr)
+                return AK_InsufficientMemory;
+            
+            for (int page = 0; page < DELAY_PAGE_COUNT; ++page)
+                pDelayLines[i].pages[page] = s_pSilentPage;
+            
+            continue;
+        }
         
-        memset(m_pDelayLines[i].buffer, 0, sizeof(float) * MAX_BUFFER_LEN);
+        // Pooled rings are borrowed on the first non-silent buffer instead
+        if (m_delayMemoryMode == DELAY_MEMORY_CONTIGUOUS)
+        {
+            // Zero is silence in every storage format
+            pDelayLines[i].buffer = (AkUInt8*)AK_PLUGIN_ALLOC(m_pAllocator, m_ringBytes);
+            if (pDelayLines[i].buffer == nullptr)
+                return AK_InsufficientMemory;
+            
+            memset(pDelayLines[i].buffer, 0, m_ringBytes);
+            
+            if (oversampleFactor > OVERSAMPLE_NONE)
+            {
+                const AkUInt32 oversampledBytes = GetDelayRingBytes(m_storageFormat, oversampleFactor);
+                pDelayLines[i].oversampledBuffer = (AkUInt8*)AK_PLUGIN_ALLOC(m_pAllocator, oversampledBytes);
+                if (pDelayLines[i].oversampledBuffer == nullptr)
+                    return AK_InsufficientMemory;
+
+                memset(pDelayLines[i].oversampledBuffer, 0, oversampledBytes);
+            }
+        }
         
         if (oversampleFactor > OVERSAMPLE_NONE)
         {
-            m_pDelayLines[i].oversampledBuffer = (float*)AK_PLUGIN_ALLOC(in_pAllocator,
-                sizeof(float) * MAX_BUFFER_LEN * oversampleFactor);
+            const AkUInt32 scratchBytes = GetOversampledScratchBytes(oversampleFactor);
+            pDelayLines[i].tempUpsampledInput = (float*)AK_PLUGIN_ALLOC(m_pAllocator, scratchBytes);
+            pDelayLines[i].tempDelayedOutput = (float*)AK_PLUGIN_ALLOC(m_pAllocator, scratchBytes);
+    
+            if (!pDelayLines[i].tempUpsampledInput || !pDelayLines[i].tempDelayedOutput)
+                return AK_InsufficientMemory;
+            
+            if (m_halfbandNumStages > 0)
+            {
+                pDelayLines[i].halfbandState = (float*)AK_PLUGIN_ALLOC(m_pAllocator, sizeof(float) * HALFBAND_STATE_LEN);
+                if (pDelayLines[i].halfbandState == nullptr)
+                    return AK_InsufficientMemory;
+                
+                memset(pDelayLines[i].halfbandState, 0, sizeof(float) * HALFBAND_STATE_LEN);
+            }
+            
+            if (m_pFIRCoefficients != nullptr)
+            {
+                pDelayLines[i].upsampleHistory = (float*)AK_PLUGIN_ALLOC(m_pAllocator, sizeof(float) * UPSAMPLE_HISTORY_LEN * 2);
+                if (pDelayLines[i].upsampleHistory == nullptr)
+                    return AK_InsufficientMemory;
+                
+                memset(pDelayLines[i].upsampleHistory, 0, sizeof(float) * UPSAMPLE_HISTORY_LEN * 2);
+            }
+        }
+    }
     
-            int maxBufferFrames = MAX_BUFFER_LEN;
-            m_pDelayLines[i].tempUpsampledInput = (float*)AK_PLUGIN_ALLOC(in_pAllocator,
-                sizeof(float) * maxBufferFrames * oversampleFactor);
+    // Objects are set up before they play, so the blocks they borrow later are ready by then
+    ReserveDelayMemory(object);
     
-            m_pDelayLines[i].tempDelayedOutput = (float*)AK_PLUGIN_ALLOC(in_pAllocator,
-                sizeof(float) * maxBufferFrames * oversampleFactor);
+    // Without it the rings simply stay while the voice is virtual
+    if (m_virtualSnapshot != VIRTUAL_SNAPSHOT_OFF)
+        AllocateSnapshot(object);
     
-            if (!m_pDelayLines[i].tempUpsampledInput || !m_pDelayLines[i].tempDelayedOutput)
-                return AK_InsufficientMemory;
+    return AK_Success;
+}
+
+void FlexibleDelayLinesFX::FreeDelayLines(DelayLineObject& object)
+{
+    if (object.pDelayLines == nullptr)
+        return;
+    
+    FreeSnapshot(object);
+    
+    if (m_delayMemoryMode == DELAY_MEMORY_POOLED)
+        DeactivateDelayMemory(object);
+    
+    UnreserveDelayMemory(object);
+    
+    DelayLineChannel* pDelayLines = object.pDelayLines;
+    for (AkUInt32 i = 0; i < object.uNumChannels; ++i)
+    {
+        if (pDelayLines[i].buffer)
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].buffer);            
+        if (pDelayLines[i].oversampledBuffer)
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].oversampledBuffer);            
+        if (pDelayLines[i].tempUpsampledInput)
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].tempUpsampledInput);
+        if (pDelayLines[i].tempDelayedOutput)
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].tempDelayedOutput);
+        if (pDelayLines[i].decimationHistory)
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].decimationHistory);
+        if (pDelayLines[i].interpolationHistory)
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].interpolationHistory);
+        if (pDelayLines[i].halfbandState)
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].halfbandState);
+        if (pDelayLines[i].upsampleHistory)
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].upsampleHistory);
+        if (pDelayLines[i].pages)
+        {
+            ReleaseDelayPages(pDelayLines[i]);
+            AK_PLUGIN_FREE(m_pAllocator, pDelayLines[i].pages);
         }
     }
+    AK_PLUGIN_FREE(m_pAllocator, pDelayLines);
+    
+    object.pDelayLines = nullptr;
+    object.uNumChannels = 0;
+}
 
-    return AK_Success;
+void FlexibleDelayLinesFX::ResetDelayLines(DelayLineObject& object)
+{
+    // Back to waiting for signal, with the memory returned to the pool
+    if (m_delayMemoryMode != DELAY_MEMORY_CONTIGUOUS)
+        DeactivateDelayMemory(object);
+    DiscardSnapshot(object);
+    
+    DelayLineChannel* pDelayLines = object.pDelayLines;
+    for (AkUInt32 i = 0; i < object.uNumChannels; ++i)
+    {
+        if (pDelayLines[i].buffer != nullptr)
+            memset(pDelayLines[i].buffer, 0, m_ringBytes);
+        
+        if (pDelayLines[i].oversampledBuffer != nullptr)
+            memset(pDelayLines[i].oversampledBuffer, 0, GetDelayRingBytes(m_storageFormat, pDelayLines[i].oversampleFactor));
+        
+        if (pDelayLines[i].pages != nullptr)
+            ReleaseDelayPages(pDelayLines[i]);
+        
+        if (pDelayLines[i].decimationHistory != nullptr)
+        {
+            memset(pDelayLines[i].decimationHistory, 0, sizeof(float) * DECIMATION_HISTORY_LEN * 2);
+            memset(pDelayLines[i].interpolationHistory, 0, sizeof(float) * INTERPOLATION_HISTORY_LEN * 2);
+        }
+        pDelayLines[i].decimationPos = 0;
+        pDelayLines[i].interpolationPos = 0;
+        pDelayLines[i].decimationPhase = 0;
+        
+        if (pDelayLines[i].halfbandState != nullptr)
+            memset(pDelayLines[i].halfbandState, 0, sizeof(float) * HALFBAND_STATE_LEN);
+        
+        if (pDelayLines[i].upsampleHistory != nullptr)
+            memset(pDelayLines[i].upsampleHistory, 0, sizeof(float) * UPSAMPLE_HISTORY_LEN * 2);
+        pDelayLines[i].upsamplePos = 0;
+        
+        pDelayLines[i].dampingLowpassState = 0.0f;
+        pDelayLines[i].dampingHighpassState = 0.0f;
+        pDelayLines[i].dcBlockerInput = 0.0f;
+        pDelayLines[i].dcBlockerOutput = 0.0f;
+        memset(pDelayLines[i].crossoverState, 0, sizeof(pDelayLines[i].crossoverState));
+        memset(pDelayLines[i].lowBandFilterState, 0, sizeof(pDelayLines[i].lowBandFilterState));
+        pDelayLines[i].airAbsorptionState = 0.0f;
+        pDelayLines[i].distanceGain = 1.0f;
+        pDelayLines[i].crossfadeFrames = 0;
+        
+        pDelayLines[i].writePos = 0;
+        pDelayLines[i].lastDelayTime = m_params.RTPC.fDelayTime;
+        pDelayLines[i].delayPhase = DelayTimeToPhase(m_params.RTPC.fDelayTime / (float)m_decimationFactor,
+            pDelayLines[i].oversampleFactor,
+            m_delayMemoryMode == DELAY_MEMORY_PAGED ? PAGED_DELAY_SPAN : pDelayLines[i].effectiveBufferSize);
+    }
+}
+
+FlexibleDelayLinesFX::DelayLineObject* FlexibleDelayLinesFX::FindObject(AkAudioObjectID key)
+{
+    for (AkUInt32 i = 0; i < m_uNumObjects; ++i)
+    {
+        if (m_pObjects[i].key == key)
+            return &m_pObjects[i];
+    }
+    return nullptr;
+}
+
+FlexibleDelayLinesFX::DelayLineObject* FlexibleDelayLinesFX::AcquireObject(AkAudioObjectID key, AkUInt32 uNumChannels)
+{
+    DelayLineObject* pObject = FindObject(key);
+    if (pObject != nullptr && pObject->uNumChannels == uNumChannels)
+        return pObject;
+    
+    // Same object with another channel configuration: start over
+    if (pObject != nullptr)
+    {
+        FreeDelayLines(*pObject);
+        if (AllocateDelayLines(*pObject, uNumChannels) != AK_Success)
+        {
+            FreeDelayLines(*pObject);
+            return nullptr;
+        }
+        ResetDelayLines(*pObject);
+        return pObject;
+    }
+    
+    // The delay lines set up at Init wait for the first object that fits them
+    for (AkUInt32 i = 0; i < m_uNumObjects; ++i)
+    {
+        if (m_pObjects[i].key == AK_INVALID_AUDIO_OBJECT_ID && m_pObjects[i].uNumChannels == uNumChannels)
+        {
+            m_pObjects[i].key = key;
+            return &m_pObjects[i];
+        }
+    }
+    
+    if (m_uNumObjects == m_uMaxObjects)
+    {
+        AkUInt32 uNewMaxObjects = m_uMaxObjects * 2;
+        DelayLineObject* pNewObjects = (DelayLineObject*)AK_PLUGIN_ALLOC(m_pAllocator, sizeof(DelayLineObject) * uNewMaxObjects);
+        if (pNewObjects == nullptr)
+            return nullptr;
+        
+        memcpy(pNewObjects, m_pObjects, sizeof(DelayLineObject) * m_uNumObjects);
+        AK_PLUGIN_FREE(m_pAllocator, m_pObjects);
+        m_pObjects = pNewObjects;
+        m_uMaxObjects = uNewMaxObjects;
+    }
+    
+    pObject = &m_pObjects[m_uNumObjects];
+    pObject->key = key;
+    pObject->bInUse = false;
+    if (AllocateDelayLines(*pObject, uNumChannels) != AK_Success)
+    {
+        FreeDelayLines(*pObject);
+        return nullptr;
+    }
+    ResetDelayLines(*pObject);
+    
+    ++m_uNumObjects;
+    return pObject;
+}
+
+void FlexibleDelayLinesFX::RemoveUnusedObjects()
+{
+    AkUInt32 i = 0;
+    while (i < m_uNumObjects)
+    {
+        if (m_pObjects[i].bInUse)
+        {
+            ++i;
+            continue;
+        }
+        
+        // Order does not matter: move the last object into the gap
+        FreeDelayLines(m_pObjects[i]);
+        m_pObjects[i] = m_pObjects[--m_uNumObjects];
+    }
 }
 
 AKRESULT FlexibleDelayLinesFX::Term(AK::IAkPluginMemAlloc* in_pAllocator)
 {
+#ifdef FLEXIBLEDELAYLINES_PROFILE_EXECUTE
+    ReportProfile();
+#endif
+    
     if (m_pFIRCoefficients != nullptr)
     {
         AK_PLUGIN_FREE(in_pAllocator, m_pFIRCoefficients);
         m_pFIRCoefficients = nullptr;
     }
     
-    if (m_pDelayLines != nullptr)
+    if (m_pDecimationFIR != nullptr)
     {
-        for (AkUInt32 i = 0; i < m_uNumChannels; ++i)
-        {
-            if (m_pDelayLines[i].buffer)
-                AK_PLUGIN_FREE(in_pAllocator, m_pDelayLines[i].buffer);            
-            if (m_pDelayLines[i].oversampledBuffer)
-                AK_PLUGIN_FREE(in_pAllocator, m_pDelayLines[i].oversampledBuffer);            
-            if (m_pDelayLines[i].tempUpsampledInput)
-                AK_PLUGIN_FREE(in_pAllocator, m_pDelayLines[i].tempUpsampledInput);
-            if (m_pDelayLines[i].tempDelayedOutput)
-                AK_PLUGIN_FREE(in_pAllocator, m_pDelayLines[i].tempDelayedOutput);
-        }
-        AK_PLUGIN_FREE(in_pAllocator, m_pDelayLines);
+        AK_PLUGIN_FREE(in_pAllocator, m_pDecimationFIR);
+        m_pDecimationFIR = nullptr;
+    }
+    
+    if (m_pInterpolationPolyphase != nullptr)
+    {
+        AK_PLUGIN_FREE(in_pAllocator, m_pInterpolationPolyphase);
+        m_pInterpolationPolyphase = nullptr;
+    }
+    
+    if (m_pObjects != nullptr)
+    {
+        for (AkUInt32 i = 0; i < m_uNumObjects; ++i)
+            FreeDelayLines(m_pObjects[i]);
+        AK_PLUGIN_FREE(in_pAllocator, m_pObjects);
     }
     
+    FlexibleDelayLinesFXMemoryPool::Get().RemoveUser();
+    
     AK_PLUGIN_DELETE(in_pAllocator, this);
     return AK_Success;
 }
 
+#ifdef FLEXIBLEDELAYLINES_PROFILE_EXECUTE
+void FlexibleDelayLinesFX::ReportProfile() const
+{
+    // The effective settings, after Init has resolved the ones that exclude each other
+    char configuration[128];
+    snprintf(configuration, sizeof(configuration),
+        "interp %u, %dx upsampler %u, storage %u, memory %u, decimation %dx, matrix %u",
+        m_params.NonRTPC.interpolationType,
+        m_oversampleFactor,
+        m_params.NonRTPC.upsamplingMethod,
+        m_storageFormat,
+        m_delayMemoryMode,
+        m_decimationFactor,
+        m_feedbackMatrix);
+    
+    m_profiler.Report(m_pContext, configuration);
+}
+#endif
+
 AKRESULT FlexibleDelayLinesFX::Reset()
 {
-    for (AkUInt32 i = 0; i < m_uNumChannels; ++i)
-    {
-        if (m_pDelayLines[i].buffer != nullptr)
-            memset(m_pDelayLines[i].buffer, 0, sizeof(float) * MAX_BUFFER_LEN);
-        
-        if (m_pDelayLines[i].oversampledBuffer != nullptr)
-            memset(m_pDelayLines[i].oversampledBuffer, 0, 
-                sizeof(float) * MAX_BUFFER_LEN * m_pDelayLines[i].oversampleFactor);
-        
-        m_pDelayLines[i].writePos = 0;
-        m_pDelayLines[i].lastDelayTime = m_pParams->RTPC.fDelayTime;
-    }
+    // A curve in progress does not survive a reset; the RTPCs drive the delay again
+    m_delayCurveNumPoints = 0;
+    
+    for (AkUInt32 i = 0; i < m_uNumObjects; ++i)
+        ResetDelayLines(m_pObjects[i]);
     
     return AK_Success;
 }
@@ -237,12 +903,12 @@ AKRESULT FlexibleDelayLinesFX::GetPluginInfo(AkPluginInfo& out_rPluginInfo)
 {
     out_rPluginInfo.eType = AkPluginTypeEffect;
     out_rPluginInfo.bIsInPlace = true;
-	out_rPluginInfo.bCanProcessObjects = false;
+	out_rPluginInfo.bCanProcessObjects = true;
     out_rPluginInfo.uBuildVersion = AK_WWISESDK_VERSION_COMBINED;
     return AK_Success;
 }
 
-void FlexibleDelayLinesFX::SimpleSincUpsample(float* input, float* output, int inputLength, int factor)
+void FlexibleDelayLinesFX::SimpleSincUpsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor)
 {
     if (factor <= 1)
     {
@@ -295,7 +961,7 @@ void FlexibleDelayLinesFX::SimpleSincUpsample(float* input, float* output, int i
     }
 }
 
-void FlexibleDelayLinesFX::LinearUpsample(float* input, float* output, int inputLength, int factor)
+void FlexibleDelayLinesFX::LinearUpsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor)
 {
     if (factor <= 1)
     {
@@ -328,234 +994,2056 @@ void FlexibleDelayLinesFX::LinearUpsample(float* input, float* output, int input
     }
 }
 
-void FlexibleDelayLinesFX::PolyphaseUpsample(float* input, float* output, int inputLength, int factor)
+void FlexibleDelayLinesFX::PolyphaseUpsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor)
 {
-    if (factor <= 1 || !m_pFIRCoefficients)
+    if (factor <= 1 || !m_pFIRCoefficients || !delayLine.upsampleHistory)
     {
         // Pas d'oversampling - copie directe
         memcpy(output, input, sizeof(float) * inputLength);
         return;
     }
     
-    int outputLength = inputLength * factor;
-    int halfLength = m_FIRLength / 2;
+    // Zero-stuffed interpolation: each output phase only meets every factor-th tap,
+    // and the input history carries over from the previous buffer
+    const int tapsPerPhase = m_FIRLength / factor;
+    float* history = delayLine.upsampleHistory;
     
-    // Pour chaque échantillon de sortie oversampleé
-    for (int i = 0; i < outputLength; ++i)
+    for (int i = 0; i < inputLength; ++i)
     {
-        float sum = 0.0f;
+        int pos = delayLine.upsamplePos;
+        history[pos] = input[i];
+        history[pos + UPSAMPLE_HISTORY_LEN] = input[i];
+        delayLine.upsamplePos = (pos + 1) & (UPSAMPLE_HISTORY_LEN - 1);
         
-        // Position dans l'input original (peut être fractionnaire)
-        float inputPos = (float)i / (float)factor;
-        int baseInputIndex = (int)inputPos;
+        const float* pNewest = history + pos + UPSAMPLE_HISTORY_LEN;
         
-        // Appliquer le filtre FIR
-        for (int j = 0; j < m_FIRLength; ++j)
+        // Pour chaque échantillon de sortie oversampleé
+        for (int phase = 0; phase < factor; ++phase)
         {
-            // Index dans l'input original
-            int inputIndex = baseInputIndex - halfLength + j;
+            float sum = 0.0f;
+            for (int tap = 0; tap < tapsPerPhase; ++tap)
+                sum += m_pFIRCoefficients[phase + tap * factor] * pNewest[-tap];
             
-            // Boundary check
-            if (inputIndex >= 0 && inputIndex < inputLength)
-            {
-                sum += input[inputIndex] * m_pFIRCoefficients[j];
-            }
+            output[i * factor + phase] = sum * (float)factor;
         }
-        
-        output[i] = sum * (float)factor;
     }
 }
 
-float FlexibleDelayLinesFX::CalculateDopplerShift(float currentDelay, float lastDelay, float bufferDuration) const
-{
-    // Doppler shift is implicit in the time gradient!
-    // The rate of change of delay time creates pitch shift
-    float delayChange = currentDelay - lastDelay;
-    float relativeVelocity = (delayChange / bufferDuration) * SPEED_OF_SOUND;
-    
-    // Doppler factor = c / (c + v) where v is relative velocity
-    // But we get this "for free" through the time-varying delay!
-    return relativeVelocity; // Just for monitoring
-}
+// ==================== FDN MIXING ====================
+// Both matrices are applied in O(N) without being stored. With SSE2, four lines go through
+// each step at once; the Hadamard butterflies give the same results as the scalar ones.
 
-void FlexibleDelayLinesFX::Execute(AkAudioBuffer* io_pBuffer)
+// In-place fast Walsh-Hadamard transform of numLines values, a power of two, then scaled
+static inline void MixHadamard(float* values, int numLines, float scale)
 {
-    const AkUInt16 uValidFrames = io_pBuffer->uValidFrames;
-    
-    // Get parameters
-    float currentDelayTime;
-    if (m_pParams->RTPC.fDistance > 0.0f)
+#ifdef FLEXIBLEDELAYLINES_SSE2
+    if (numLines >= 4)
     {
-        currentDelayTime = (m_pParams->RTPC.fDistance * 2.0f) / SPEED_OF_SOUND;
+        // Spans 1 and 2 stay within a vector: add the swapped neighbours to the negated odd ones
+        const __m128 negateOdd = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+        const __m128 negateHigh = _mm_set_ps(-0.0f, -0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < numLines; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(values + i);
+            v = _mm_add_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)), _mm_xor_ps(v, negateOdd));
+            v = _mm_add_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)), _mm_xor_ps(v, negateHigh));
+            _mm_storeu_ps(values + i, v);
+        }
+        
+        for (int span = 4; span < numLines; span <<= 1)
+        {
+            for (int block = 0; block < numLines; block += span << 1)
+            {
+                for (int i = block; i < block + span; i += 4)
+                {
+                    const __m128 a = _mm_loadu_ps(values + i);
+                    const __m128 b = _mm_loadu_ps(values + i + span);
+                    _mm_storeu_ps(values + i, _mm_add_ps(a, b));
+                    _mm_storeu_ps(values + i + span, _mm_sub_ps(a, b));
+                }
+            }
+        }
+        
+        const __m128 scale4 = _mm_set1_ps(scale);
+        for (int i = 0; i < numLines; i += 4)
+            _mm_storeu_ps(values + i, _mm_mul_ps(_mm_loadu_ps(values + i), scale4));
+        return;
     }
-    else
+#endif
+    for (int span = 1; span < numLines; span <<= 1)
     {
-        currentDelayTime = m_pParams->RTPC.fDelayTime;
+        for (int block = 0; block < numLines; block += span << 1)
+        {
+            for (int i = block; i < block + span; ++i)
+            {
+                float a = values[i];
+                float b = values[i + span];
+                values[i] = a + b;
+                values[i + span] = a - b;
+            }
+        }
     }
     
-    float wetDryMix = m_pParams->RTPC.fWetDryMix;
-    float feedback = m_pParams->RTPC.fFeedback;
+    for (int line = 0; line < numLines; ++line)
+        values[line] *= scale;
+}
+
+// Householder reflection I - scale * ones: one sum across the lines, then one subtraction from each
+static inline void MixHouseholder(const float* in, float* out, int numLines, float scale)
+{
+    int line = 0;
+    float sum = 0.0f;
+#ifdef FLEXIBLEDELAYLINES_SSE2
+    __m128 sum4 = _mm_setzero_ps();
+    for (; line + 4 <= numLines; line += 4)
+        sum4 = _mm_add_ps(sum4, _mm_loadu_ps(in + line));
     
-    InterpolationType interpType = (InterpolationType)m_pParams->NonRTPC.interpolationType;
-    int oversampleFactor = m_pParams->NonRTPC.oversamplingFactor;
+    sum4 = _mm_add_ps(sum4, _mm_shuffle_ps(sum4, sum4, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum = _mm_cvtss_f32(sum4);
+#endif
+    for (; line < numLines; ++line)
+        sum += in[line];
+    
+    const float reflection = sum * scale;
+    line = 0;
+#ifdef FLEXIBLEDELAYLINES_SSE2
+    const __m128 reflection4 = _mm_set1_ps(reflection);
+    for (; line + 4 <= numLines; line += 4)
+        _mm_storeu_ps(out + line, _mm_sub_ps(_mm_loadu_ps(in + line), reflection4));
+#endif
+    for (; line < numLines; ++line)
+        out[line] = in[line] - reflection;
+}
+
+// One 2x half-band stage: two chains of first-order allpasses running side by side,
+// the coefficients alternating between them. Memory holds each section's last input then last output.
+static inline void ProcessHalfbandPaths(const float* coefs, int numCoefs, float* state, float& path0, float& path1)
+{
+    float* x = state;
+    float* y = state + numCoefs;
     
-    // Process each channel
-    for (AkUInt32 chan = 0; chan < m_uNumChannels; ++chan)
+    for (int i = 0; i < numCoefs; i += 2)
     {
-        DelayLineChannel& delayLine = m_pDelayLines[chan];
-        float* pChannel = io_pBuffer->GetChannel(chan);
+        float out0 = (path0 - y[i]) * coefs[i] + x[i];
+        float out1 = (path1 - y[i + 1]) * coefs[i + 1] + x[i + 1];
         
-        // Calculate Doppler shift (for monitoring/debugging)
-        float bufferDuration = (float)uValidFrames / m_fSampleRate;
-        float dopplerVelocity = CalculateDopplerShift(currentDelayTime, delayLine.lastDelayTime, bufferDuration);
-        (void)dopplerVelocity;
+        x[i] = path0;
+        x[i + 1] = path1;
+        y[i] = out0;
+        y[i + 1] = out1;
         
-        // Time gradient for smooth delay changes
-        float timeGradient = (currentDelayTime - delayLine.lastDelayTime) / (float)uValidFrames;
-        float currDelayTime = delayLine.lastDelayTime;
+        path0 = out0;
+        path1 = out1;
+    }
+}
+
+void FlexibleDelayLinesFX::HalfbandUpsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor)
+{
+    // Each stage reads from the back half of its output span, so the whole
+    // cascade runs inside the output buffer without overwriting unread samples
+    const int outputLength = inputLength * factor;
+    float* pStage = output + outputLength - inputLength;
+    memcpy(pStage, input, sizeof(float) * inputLength);
+    
+    int stageLength = inputLength;
+    for (int stage = 0; stage < m_halfbandNumStages; ++stage)
+    {
+        float* pStageOutput = output + outputLength - stageLength * 2;
+        float* state = delayLine.halfbandState + stage * HALFBAND_STAGE_STATE_LEN;
         
-        // Choose processing path based on oversampling
-        if (oversampleFactor > 1 
-            && delayLine.oversampledBuffer
-            && delayLine.tempUpsampledInput 
-            && delayLine.tempDelayedOutput)
+        for (int i = 0; i < stageLength; ++i)
         {
-            // ==================== OVERSAMPLED PATH ====================
+            float path0 = pStage[i];
+            float path1 = pStage[i];
+            ProcessHalfbandPaths(m_halfbandCoefs[stage], m_halfbandNumCoefs[stage], state, path0, path1);
             
-            float* tempUpsampledInput = delayLine.tempUpsampledInput;
-            float* tempDelayedOutput = delayLine.tempDelayedOutput;
-            
-            (this->*m_upsampleFunction)(pChannel, tempUpsampledInput, uValidFrames, oversampleFactor);            
+            pStageOutput[i * 2] = path0;
+            pStageOutput[i * 2 + 1] = path1;
+        }
+        
+        pStage = pStageOutput;
+        stageLength *= 2;
+    }
+}
+
+void FlexibleDelayLinesFX::HalfbandDownsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor)
+{
+    // Highest rate first; every stage halves the signal in place in the input, the last one
+    // writes the output, which holds inputLength samples only
+    int stageLength = inputLength * factor;
+    float* pStage = input;
+    
+    for (int stage = m_halfbandNumStages - 1; stage >= 0; --stage)
+    {
+        float* state = delayLine.halfbandState + (HALFBAND_MAX_STAGES + stage) * HALFBAND_STAGE_STATE_LEN;
+        float* pOut = stage == 0 ? output : input;
+        stageLength /= 2;
+        
+        for (int i = 0; i < stageLength; ++i)
+        {
+            float path0 = pStage[i * 2 + 1];
+            float path1 = pStage[i * 2];
+            ProcessHalfbandPaths(m_halfbandCoefs[stage], m_halfbandNumCoefs[stage], state, path0, path1);
             
-            int oversampledFrames = uValidFrames * oversampleFactor;
-            float oversampledTimeGradient = timeGradient / (float)oversampleFactor;
-            float currDelayTimeOS = currDelayTime;
+            pOut[i] = 0.5f * (path0 + path1);
+        }
+        
+        pStage = pOut;
+    }
+}
+
+void FlexibleDelayLinesFX::DropSampleDownsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor)
+{
+    for (int i = 0; i < inputLength; ++i)
+        output[i] = input[i * factor];
+}
+
+AkInt64 FlexibleDelayLinesFX::GetMinDelayPhase(AkInt64 startPhase, const DelayLineBlockParams& blockParams, int numFrames, int oversampleFactor, int bufferSize) const
+{
+    // The ramp between targets is linear, so the ends of each segment bound it
+    AkInt64 minPhase = startPhase;
+    if (blockParams.pDelayCurve)
+    {
+        const int numSegments = (numFrames + blockParams.curveSegmentFrames - 1) / blockParams.curveSegmentFrames;
+        for (int segment = 0; segment < numSegments; ++segment)
+        {
+            const AkInt64 phase = DelayTimeToPhase(blockParams.pDelayCurve[segment], oversampleFactor, bufferSize);
+            if (phase < minPhase)
+                minPhase = phase;
+        }
+    }
+    else
+    {
+        const AkInt64 phase = DelayTimeToPhase(blockParams.delayTime, oversampleFactor, bufferSize);
+        if (phase < minPhase)
+            minPhase = phase;
+    }
+    return minPhase;
+}
+
+const float* FlexibleDelayLinesFX::GetResamplerKernels(AkInt64 phaseIncrement) const
+{
+    // The head plays the ring back at 1 - d(delay)/dt, the Doppler factor: a shrinking
+    // delay raises the pitch, and whatever ends up above Nyquist folds back down
+    float dopplerFactor = fabsf(1.0f - (float)phaseIncrement * DELAY_PHASE_FRAC_SCALE);
+    
+    int band = 0;
+    while (dopplerFactor > s_resamplerMaxFactors[band])
+        ++band;
+    
+    return m_pResamplerKernels + band * RESAMPLER_BAND_LEN;
+}
+
+template<typename Storage>
+inline float FlexibleDelayLinesFX::ReadOversampledTap(const DelayLineChannel& delayLine, AkInt64 delayPhase, InterpolationType interpType) const
+{
+    int wholeSampleDelay = (int)(delayPhase >> DELAY_PHASE_SHIFT);
+    float subSampleDelay = (float)(delayPhase & DELAY_PHASE_FRAC_MASK) * DELAY_PHASE_FRAC_SCALE;
+    
+    int readPosA = (delayLine.writePos - wholeSampleDelay) & (delayLine.effectiveBufferSize - 1);
+    int readPosB = (delayLine.writePos - wholeSampleDelay - 1) & (delayLine.effectiveBufferSize - 1);
+    
+    float valueA = Storage::Load(delayLine.oversampledBuffer, readPosA);
+    float valueB = Storage::Load(delayLine.oversampledBuffer, readPosB);
+    
+    // A pooled ring still filling up only holds audio from its first write on, see FillingRing
+    if (delayLine.firstWritePos >= 0)
+    {
+        const int bufferMask = delayLine.effectiveBufferSize - 1;
+        const int numWritten = (delayLine.writePos - delayLine.firstWritePos) & bufferMask;
+        if (((readPosA - delayLine.firstWritePos) & bufferMask) >= numWritten)
+            valueA = 0.0f;
+        if (((readPosB - delayLine.firstWritePos) & bufferMask) >= numWritten)
+            valueB = 0.0f;
+    }
+    
+    if (interpType == INTERP_HYBRID || interpType == INTERP_LINEAR)
+    {
+        return InterpolateLinear(valueA, valueB, subSampleDelay);
+    }
+    
+    return valueA;
+}
+
+template<typename Storage, bool WET_ONLY>
+void FlexibleDelayLinesFX::ProcessOversampled(DelayLineChannel& delayLine, float* pChannel, AkUInt16 uValidFrames, const DelayLineBlockParams& blockParams)
+{
+    const float currentDelayTime = blockParams.delayTime;
+    const float* pDelayCurve = blockParams.pDelayCurve;
+    const float wetDryMix = blockParams.wetDryMix;
+    const float feedback = blockParams.feedback;
+    const InterpolationType interpType = blockParams.interpType;
+    const int oversampleFactor = blockParams.oversampleFactor;
+    const FeedbackFilter feedbackFilter = blockParams.feedbackFilter;
+    
+    // ==================== OVERSAMPLED PATH ====================
+    
+    float* tempUpsampledInput = delayLine.tempUpsampledInput;
+    float* tempDelayedOutput = delayLine.tempDelayedOutput;
+    int oversampledFrames = uValidFrames * oversampleFactor;
+    
+    // The scratch buffers are sized for MAX_BUFFER_LEN base frames: the low band fits after the
+    // upsampled input, and the high band waits in the delayed output until the loop below fills it
+    float* pUpsamplerInput = pChannel;
+    float* pLowBand = nullptr;
+    if (m_bBandSplit)
+    {
+        pLowBand = tempUpsampledInput + oversampledFrames;
+        pUpsamplerInput = tempDelayedOutput;
+        ProcessLowBand<Storage>(delayLine, pChannel, pLowBand, pUpsamplerInput, uValidFrames, blockParams);
+    }
+    
+    (this->*m_upsampleFunction)(delayLine, pUpsamplerInput, tempUpsampledInput, uValidFrames, oversampleFactor);            
+    
+    // Ramp the fixed-point delay phase smoothly towards the new delay, re-aimed
+    // at every control point when a delay curve is running
+    const int segmentFrames = pDelayCurve ? blockParams.curveSegmentFrames * oversampleFactor : oversampledFrames;
+    AkInt64 targetPhase = delayLine.delayPhase;
+    AkInt64 phaseIncrement = 0;
+    AkInt64 delayPhase = delayLine.delayPhase;
+    int segmentEnd = 0;
+    int segment = 0;
+    const AkInt64 latencyPhase = m_oversamplingLatencyPhase;
+    const int bufferMask = delayLine.effectiveBufferSize - 1;
+    
+    // Hold the writes back and store them a run at a time when no head reads that close;
+    // the output tap is the closer one
+    const int stagedWriteLength = Storage::BATCHED_STORE
+        ? GetStagedWriteLength(GetMinDelayPhase(delayPhase, blockParams, uValidFrames, oversampleFactor, delayLine.effectiveBufferSize) - latencyPhase)
+        : 0;
+    float stagedWrites[STAGED_WRITE_LEN];
+    int numStagedWrites = 0;
+    
+    // Process oversampled samples
+    for (int frame = 0; frame < oversampledFrames; ++frame)
+    {
+        if (frame == segmentEnd)
+        {
+            // Restart from the previous target exactly, so that rounding never accumulates
+            delayPhase = targetPhase;
+            segmentEnd = frame + segmentFrames < oversampledFrames ? frame + segmentFrames : oversampledFrames;
             
-            // Process oversampled samples
-            for (int frame = 0; frame < oversampledFrames; ++frame)
-            {
-                float samplesDelayed = currDelayTimeOS * m_fSampleRate * (float)oversampleFactor;
-                int wholeSampleDelay = (int)samplesDelayed;
-                float subSampleDelay = samplesDelayed - (float)wholeSampleDelay;
-                
-                int readPosA = (delayLine.writePos - wholeSampleDelay) & (delayLine.effectiveBufferSize - 1);
-                int readPosB = (delayLine.writePos - wholeSampleDelay - 1) & (delayLine.effectiveBufferSize - 1);
-                
-                float valueA = delayLine.oversampledBuffer[readPosA];
-                float valueB = delayLine.oversampledBuffer[readPosB];
-                
-                float delayedSample;
-                if (interpType == INTERP_HYBRID || interpType == INTERP_LINEAR)
-                {
-                    delayedSample = InterpolateLinear(valueA, valueB, subSampleDelay);
-                }
-                else
-                {
-                    delayedSample = valueA;
-                }
-                
-                tempDelayedOutput[frame] = delayedSample;
-                
-                float inputWithFeedback = tempUpsampledInput[frame] + (delayedSample * feedback);
-                
-                delayLine.oversampledBuffer[delayLine.writePos] = inputWithFeedback;
-                
-                delayLine.writePos = (delayLine.writePos + 1) & (delayLine.effectiveBufferSize - 1);
-                
-                currDelayTimeOS += oversampledTimeGradient;
-            }
+            float segmentDelayTime = pDelayCurve ? pDelayCurve[segment++] : currentDelayTime;
+            targetPhase = DelayTimeToPhase(segmentDelayTime, oversampleFactor, delayLine.effectiveBufferSize);
+            phaseIncrement = (targetPhase - delayPhase) / (AkInt64)(segmentEnd - frame);
+        }
+        
+        float delayedSample = ReadOversampledTap<Storage>(delayLine, delayPhase, interpType);
+        
+        // The feedback tap keeps the full delay so the echoes stay evenly spaced; the output
+        // tap runs ahead by the filters' latency, at least one sample behind the write head
+        if (latencyPhase > 0)
+        {
+            AkInt64 outputPhase = delayPhase - latencyPhase;
+            if (outputPhase < DELAY_PHASE_ONE)
+                outputPhase = DELAY_PHASE_ONE;
             
-            for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
+            tempDelayedOutput[frame] = ReadOversampledTap<Storage>(delayLine, outputPhase, interpType);
+        }
+        else
+        {
+            tempDelayedOutput[frame] = delayedSample;
+        }
+        
+        float feedbackSample = delayedSample * feedback;
+        if (feedbackFilter.bEnabled)
+            feedbackSample = ApplyFeedbackFilter(delayLine, feedbackFilter, feedbackSample);
+        
+        float inputWithFeedback = tempUpsampledInput[frame] + feedbackSample;
+        
+        if (stagedWriteLength > 0)
+        {
+            stagedWrites[numStagedWrites++] = inputWithFeedback;
+            if (numStagedWrites == stagedWriteLength)
             {
-                float delayedSample = tempDelayedOutput[frame * oversampleFactor];
-                
-                // Mix wet/dry
-                pChannel[frame] = pChannel[frame] * (1.0f - wetDryMix) + delayedSample * wetDryMix;
+                StoreRingBlock<Storage>(delayLine.oversampledBuffer, bufferMask,
+                    (delayLine.writePos + 1 - numStagedWrites) & bufferMask, stagedWrites, numStagedWrites);
+                numStagedWrites = 0;
             }
         }
         else
         {
-            // ==================== STANDARD PATH (NO OVERSAMPLING) ====================
-            
+            Storage::Store(delayLine.oversampledBuffer, delayLine.writePos, inputWithFeedback);
+        }
+        
+        delayLine.writePos = (delayLine.writePos + 1) & bufferMask;
+        
+        delayPhase += phaseIncrement;
+    }
+    
+    if (numStagedWrites > 0)
+    {
+        StoreRingBlock<Storage>(delayLine.oversampledBuffer, bufferMask,
+            (delayLine.writePos - numStagedWrites) & bufferMask, stagedWrites, numStagedWrites);
+    }
+    
+    delayLine.delayPhase = targetPhase;
+    
+    DistanceFilter distanceFilter = ComputeDistanceFilter(delayLine, blockParams, m_fSampleRate, uValidFrames);
+    
+    // Wet only: the input is in the upsampled scratch already, the downsampler writes the output directly
+    if (WET_ONLY)
+    {
+        (this->*m_downsampleFunction)(delayLine, tempDelayedOutput, pChannel, uValidFrames, oversampleFactor);
+        
+        if (pLowBand != nullptr)
+        {
             for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
-            {
-                float samplesDelayed = currDelayTime * m_fSampleRate;
-                int wholeSampleDelay = (int)samplesDelayed;
-                float subSampleDelay = samplesDelayed - (float)wholeSampleDelay;
-                
-                int readPosA = (delayLine.writePos - wholeSampleDelay) & BIT_MASK;
-                int readPosB = (delayLine.writePos - wholeSampleDelay - 1) & BIT_MASK;
-                
-                float delayedSample;
-                
-                // Choose interpolation method
-                switch (interpType)
-                {
-                case INTERP_LINEAR:
-                {
-                    float valueA = delayLine.buffer[readPosA];
-                    float valueB = delayLine.buffer[readPosB];
-                    delayedSample = InterpolateLinear(valueA, valueB, subSampleDelay);
-                    break;
-                }
-                
-                case INTERP_POWER_COMPLEMENTARY:
-                {
-                    float valueA = delayLine.buffer[readPosA];
-                    float valueB = delayLine.buffer[readPosB];
-                    delayedSample = InterpolatePowerComplementary(valueA, valueB, subSampleDelay);
-                    break;
-                }
-                
-                case INTERP_POLYNOMIAL_4POINT:
-                {
-                    delayedSample = InterpolatePolynomial4Point(delayLine.buffer, 
-                        readPosA, subSampleDelay);
-                    break;
-                }
-                
-                case INTERP_HYBRID:
-                default:
-                {
-                    // Fallback to linear if hybrid without oversampling
-                    float valueA = delayLine.buffer[readPosA];
-                    float valueB = delayLine.buffer[readPosB];
-                    delayedSample = InterpolateLinear(valueA, valueB, subSampleDelay);
-                    break;
-                }
-                }
-                
-                // Apply feedback
-                float inputWithFeedback = pChannel[frame] + (delayedSample * feedback);
-                delayLine.buffer[delayLine.writePos] = inputWithFeedback;
-                
-                delayLine.writePos = (delayLine.writePos + 1) & BIT_MASK;
-                
-                // Output with wet/dry mix
-                pChannel[frame] = pChannel[frame] * (1.0f - wetDryMix) + delayedSample * wetDryMix;
-                
-                currDelayTime += timeGradient;
-            }
+                pChannel[frame] += pLowBand[frame];
+        }
+        
+        if (distanceFilter.bEnabled)
+        {
+            for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
+                pChannel[frame] = ApplyDistanceFilter(delayLine, distanceFilter, pChannel[frame]);
+        }
+        
+        delayLine.distanceGain = distanceFilter.targetGain;
+        return;
+    }
+    
+    (this->*m_downsampleFunction)(delayLine, tempDelayedOutput, tempDelayedOutput, uValidFrames, oversampleFactor);
+    
+    if (pLowBand != nullptr)
+    {
+        for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
+            tempDelayedOutput[frame] += pLowBand[frame];
+    }
+    
+    for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
+    {
+        float delayedSample = tempDelayedOutput[frame];
+        if (distanceFilter.bEnabled)
+            delayedSample = ApplyDistanceFilter(delayLine, distanceFilter, delayedSample);
+        
+        // Mix wet/dry
+        pChannel[frame] = pChannel[frame] * (1.0f - wetDryMix) + delayedSample * wetDryMix;
+    }
+    
+    delayLine.distanceGain = distanceFilter.targetGain;
+}
+
+template<typename Storage>
+void FlexibleDelayLinesFX::ProcessLowBand(DelayLineChannel& delayLine, const float* pInput, float* pLowBand, float* pHighBand,
+    AkUInt16 uValidFrames, const DelayLineBlockParams& blockParams)
+{
+    const float* pDelayCurve = blockParams.pDelayCurve;
+    const float feedback = blockParams.feedback;
+    const int oversampleFactor = blockParams.oversampleFactor;
+    const FeedbackFilter feedbackFilter = blockParams.lowBandFeedbackFilter;
+    const float b0 = m_crossoverCoefs[0];
+    const float b1 = m_crossoverCoefs[1];
+    const float b2 = m_crossoverCoefs[2];
+    const float a1 = m_crossoverCoefs[3];
+    const float a2 = m_crossoverCoefs[4];
+    float* crossover = delayLine.crossoverState;
+    float* filterState = delayLine.lowBandFilterState;
+    
+    // The base-rate ring sits idle next to the oversampled one; the oversampled write head
+    // only ever stops on whole base-rate frames, so both heads stay in step
+    PooledRing<Storage> ring(delayLine);
+    int writePos = delayLine.writePos / oversampleFactor;
+    if (ring.firstWritePos >= 0)
+        ring.firstWritePos /= oversampleFactor;
+    
+    // Follow the oversampled head's ramp: no latency to take off here, its output tap already
+    // runs ahead by the filters' latency so that both bands land on the requested delay
+    const int segmentFrames = pDelayCurve ? blockParams.curveSegmentFrames : uValidFrames;
+    AkInt64 targetPhase = delayLine.delayPhase / oversampleFactor;
+    AkInt64 phaseIncrement = 0;
+    AkInt64 delayPhase = targetPhase;
+    int segmentEnd = 0;
+    int segment = 0;
+    
+    for (int frame = 0; frame < uValidFrames; ++frame)
+    {
+        if (frame == segmentEnd)
+        {
+            delayPhase = targetPhase;
+            segmentEnd = frame + segmentFrames < uValidFrames ? frame + segmentFrames : uValidFrames;
+            
+            float segmentDelayTime = pDelayCurve ? pDelayCurve[segment++] : blockParams.delayTime;
+            targetPhase = DelayTimeToPhase(segmentDelayTime, oversampleFactor, delayLine.effectiveBufferSize) / oversampleFactor;
+            phaseIncrement = (targetPhase - delayPhase) / (AkInt64)(segmentEnd - frame);
+        }
+        
+        // Transposed direct form II, twice
+        const float x = pInput[frame];
+        const float y = b0 * x + crossover[0];
+        crossover[0] = b1 * x - a1 * y + crossover[1];
+        crossover[1] = b2 * x - a2 * y;
+        const float low = b0 * y + crossover[2];
+        crossover[2] = b1 * y - a1 * low + crossover[3];
+        crossover[3] = b2 * y - a2 * low;
+        
+        pHighBand[frame] = x - low;
+        
+        // The 4-point interpolator is as clean at 1x below a few kHz as the oversampled path
+        float delayedSample = ReadStandardTap(ring, writePos, delayPhase, INTERP_POLYNOMIAL_4POINT, nullptr);
+        
+        float feedbackSample = delayedSample * feedback;
+        if (feedbackFilter.bEnabled)
+        {
+            feedbackSample = ApplyFeedbackFilter(feedbackFilter, feedbackSample,
+                filterState[0], filterState[1], filterState[2], filterState[3]);
+        }
+        
+        ring.Write(writePos, low + feedbackSample);
+        writePos = (writePos + 1) & BIT_MASK;
+        
+        pLowBand[frame] = delayedSample;
+        delayPhase += phaseIncrement;
+    }
+}
+
+FlexibleDelayLinesFX::FeedbackFilter FlexibleDelayLinesFX::ComputeFeedbackFilter(float dampingLowpass, float dampingHighpass, bool bDCBlocker, float loopSampleRate) const
+{
+    const float twoPiOverRate = 2.0f * PI / loopSampleRate;
+    const float nyquist = 0.5f * loopSampleRate;
+    
+    FeedbackFilter filter;
+    
+    // Cutoffs at the top of their range switch the stage off rather than leave a slight tilt
+    const bool bLowpass = dampingLowpass < DAMPING_LOWPASS_OFF && dampingLowpass < nyquist;
+    filter.lowpass = bLowpass ? 1.0f - expf(-twoPiOverRate * dampingLowpass) : 1.0f;
+    
+    const bool bHighpass = dampingHighpass > 0.0f;
+    filter.highpass = bHighpass ? 1.0f - expf(-twoPiOverRate * dampingHighpass) : 0.0f;
+    
+    filter.dcBlocker = 1.0f - twoPiOverRate * DC_BLOCKER_CUTOFF;
+    filter.bDCBlocker = bDCBlocker;
+    filter.bEnabled = bLowpass || bHighpass || filter.bDCBlocker;
+    return filter;
+}
+
+FlexibleDelayLinesFX::DistanceFilter FlexibleDelayLinesFX::ComputeDistanceFilter(const DelayLineChannel& delayLine,
+    const DelayLineBlockParams& blockParams, float sampleRate, int numFrames) const
+{
+    const float distance = blockParams.distance;
+    
+    DistanceFilter filter;
+    filter.absorption = 1.0f;
+    filter.targetGain = 1.0f;
+    filter.bEnabled = blockParams.distanceEffects != DISTANCE_EFFECTS_NONE && distance > 0.0f;
+    
+    if (filter.bEnabled && (blockParams.distanceEffects & DISTANCE_EFFECT_AIR_ABSORPTION))
+    {
+        // Classical absorption grows with the square of frequency:
+        // the corner sits where the path has lost 3 dB
+        float cutoff = sqrtf(3.0f / (AIR_ABSORPTION_DB * distance));
+        if (cutoff < 0.5f * sampleRate)
+            filter.absorption = 1.0f - expf(-2.0f * PI * cutoff / sampleRate);
+    }
+    
+    if (filter.bEnabled && (blockParams.distanceEffects & DISTANCE_EFFECT_ATTENUATION))
+    {
+        float referenceDistance = blockParams.referenceDistance > MIN_REFERENCE_DISTANCE
+            ? blockParams.referenceDistance : MIN_REFERENCE_DISTANCE;
+        filter.targetGain = distance > referenceDistance ? referenceDistance / distance : 1.0f;
+    }
+    
+    // Ramp from where the last buffer ended so a moving source does not click
+    filter.gain = filter.bEnabled ? delayLine.distanceGain : 1.0f;
+    filter.gainStep = numFrames > 0 ? (filter.targetGain - filter.gain) / (float)numFrames : 0.0f;
+    return filter;
+}
+
+template<typename Ring>
+inline float FlexibleDelayLinesFX::ReadStandardTap(const Ring& ring, int writePos, AkInt64 delayPhase, InterpolationType interpType,
+    const float* pResamplerKernels) const
+{
+    // A pooled ring still filling up reads silence from its first write back, and over what a
+    // snapshot restore has not reached; only the taps that reach that far, or up to the write head,
+    // check every sample
+    if (Ring::IS_POOLED && (ring.firstWritePos >= 0 || ring.numRestoreFrames > 0))
+    {
+        const int wholeSampleDelay = (int)(delayPhase >> DELAY_PHASE_SHIFT);
+        const int numWritten = ring.firstWritePos >= 0 ? (writePos - ring.firstWritePos) & Ring::MASK : Ring::MASK + 1;
+        const int restoreAge = ((writePos - ring.restorePos - 1) & Ring::MASK) + 1;
+        if (wholeSampleDelay < 2 || wholeSampleDelay + 2 * INTERPOLATOR_REACH >= numWritten
+            || (ring.numRestoreFrames > 0
+                && wholeSampleDelay + 2 * INTERPOLATOR_REACH > restoreAge - ring.numRestoreFrames
+                && wholeSampleDelay < restoreAge + 2 * INTERPOLATOR_REACH))
+        {
+            return InterpolateStandardTap(FillingRing<Ring>(ring, writePos), writePos, delayPhase, interpType, pResamplerKernels);
         }
+    }
+    
+    return InterpolateStandardTap(ring, writePos, delayPhase, interpType, pResamplerKernels);
+}
+
+template<typename Ring>
+inline float FlexibleDelayLinesFX::InterpolateStandardTap(const Ring& ring, int writePos, AkInt64 delayPhase, InterpolationType interpType,
+    const float* pResamplerKernels) const
+{
+    int wholeSampleDelay = (int)(delayPhase >> DELAY_PHASE_SHIFT);
+    float subSampleDelay = (float)(delayPhase & DELAY_PHASE_FRAC_MASK) * DELAY_PHASE_FRAC_SCALE;
+    
+    int readPosA = (writePos - wholeSampleDelay) & Ring::MASK;
+    int readPosB = (writePos - wholeSampleDelay - 1) & Ring::MASK;
+    
+    // Choose interpolation method
+    switch (interpType)
+    {
+    case INTERP_LINEAR:
+        return InterpolateLinear(ring.Read(readPosA), ring.Read(readPosB), subSampleDelay);
+    
+    case INTERP_POWER_COMPLEMENTARY:
+        return InterpolatePowerComplementary(ring.Read(readPosA), ring.Read(readPosB), subSampleDelay);
+    
+    case INTERP_POLYNOMIAL_4POINT:
+        // Interpolate forward from the older sample so the fraction
+        // runs in the same direction as the other interpolators
+        return InterpolatePolynomial4Point(ring, readPosB, 1.0f - subSampleDelay);
+    
+    case INTERP_RESAMPLER:
+    {
+        // The kernel spans RESAMPLER_TAPS / 2 samples on either side of the read point:
+        // shorter delays read that much later, so it never reaches past the write head
+        int centerDelay = wholeSampleDelay;
+        if (centerDelay < RESAMPLER_TAPS / 2)
+            centerDelay = RESAMPLER_TAPS / 2;
+        else if (centerDelay > Ring::DELAY_SPAN - RESAMPLER_TAPS / 2 - 1)
+            centerDelay = Ring::DELAY_SPAN - RESAMPLER_TAPS / 2 - 1;
         
-        delayLine.lastDelayTime = currentDelayTime;
+        return InterpolateResampler(ring, writePos - centerDelay + RESAMPLER_TAPS / 2 - 1, subSampleDelay, pResamplerKernels);
+    }
+    
+    case INTERP_HYBRID:
+    default:
+        // Fallback to linear if hybrid without oversampling
+        return InterpolateLinear(ring.Read(readPosA), ring.Read(readPosB), subSampleDelay);
     }
 }
 
-AKRESULT FlexibleDelayLinesFX::TimeSkip(AkUInt32 in_uFrames)
+template<typename Ring, bool WET_ONLY>
+void FlexibleDelayLinesFX::ProcessStandard(DelayLineChannel& delayLine, float* pChannel, AkUInt16 uValidFrames, const DelayLineBlockParams& blockParams)
 {
-    for (AkUInt32 chan = 0; chan < m_uNumChannels; ++chan)
+    const float currentDelayTime = blockParams.delayTime;
+    const float* pDelayCurve = blockParams.pDelayCurve;
+    const float wetDryMix = blockParams.wetDryMix;
+    const float feedback = blockParams.feedback;
+    const InterpolationType interpType = blockParams.interpType;
+    
+    // The decimated loop runs this kernel at the reduced rate, which m_fLoopSampleRate accounts for
+    const FeedbackFilter feedbackFilter = blockParams.feedbackFilter;
+    DistanceFilter distanceFilter = ComputeDistanceFilter(delayLine, blockParams, m_fSampleRate, uValidFrames);
+    
+    // ==================== STANDARD PATH (NO OVERSAMPLING) ====================
+    
+    // Ramping across a jump faster than the threshold would sweep the pitch through the whole
+    // buffer: leave the old head where it is and crossfade to a second head at the new delay.
+    // A jump during a crossfade restarts it from the head that was fading in.
+    if (!pDelayCurve && blockParams.jumpThreshold > 0.0f && uValidFrames > 0)
+    {
+        AkInt64 jumpPhase = DelayTimeToPhase(currentDelayTime, OVERSAMPLE_NONE, Ring::DELAY_SPAN);
+        AkInt64 jump = jumpPhase > delayLine.delayPhase ? jumpPhase - delayLine.delayPhase : delayLine.delayPhase - jumpPhase;
+        
+        if ((float)jump * DELAY_PHASE_FRAC_SCALE > blockParams.jumpThreshold * (float)uValidFrames)
+        {
+            int crossfadeLength = (int)(blockParams.crossfadeTime * m_fSampleRate / (float)m_decimationFactor);
+            delayLine.fadePhase = delayLine.delayPhase;
+            delayLine.delayPhase = jumpPhase;
+            delayLine.crossfadeLength = crossfadeLength > 1 ? crossfadeLength : 1;
+            delayLine.crossfadeFrames = delayLine.crossfadeLength;
+        }
+    }
+    
+    // Without the pages to write into, let the dry signal through until the pool recovers
+    if (Ring::IS_PAGED)
+    {
+        AkInt64 maxPhase = DelayTimeToPhase(blockParams.maxDelayTime, OVERSAMPLE_NONE, Ring::DELAY_SPAN);
+        if (delayLine.crossfadeFrames > 0 && delayLine.fadePhase > maxPhase)
+            maxPhase = delayLine.fadePhase;
+        
+        if (!UpdateDelayPages(delayLine, maxPhase, uValidFrames))
+            return;
+    }
+    
+    // A block reads up to SHORT_STEADY_BLOCK frames behind its first write, and never as far as the
+    // frames its writes replace
+    const int wholeSampleDelay = (int)(delayLine.delayPhase >> DELAY_PHASE_SHIFT);
+    if (Ring::MASK == SHORT_BUFFER_LEN - 1
+        && !pDelayCurve
+        && delayLine.crossfadeFrames == 0
+        && wholeSampleDelay > SHORT_STEADY_BLOCK
+        && wholeSampleDelay <= SHORT_DELAY_SPAN
+        && DelayTimeToPhase(currentDelayTime, OVERSAMPLE_NONE, Ring::DELAY_SPAN) == delayLine.delayPhase)
+    {
+        if (interpType == INTERP_POLYNOMIAL_4POINT)
+        {
+            ProcessShortSteady<Ring, WET_ONLY, true>(delayLine, pChannel, uValidFrames, blockParams, distanceFilter);
+            return;
+        }
+        if (interpType == INTERP_LINEAR || interpType == INTERP_HYBRID)
+        {
+            ProcessShortSteady<Ring, WET_ONLY, false>(delayLine, pChannel, uValidFrames, blockParams, distanceFilter);
+            return;
+        }
+    }
+    
+    Ring ring(delayLine);
+    
+    // Ramp the fixed-point delay phase smoothly towards the new delay, re-aimed
+    // at every control point when a delay curve is running
+    const int segmentFrames = pDelayCurve ? blockParams.curveSegmentFrames : uValidFrames;
+    AkInt64 targetPhase = delayLine.delayPhase;
+    AkInt64 phaseIncrement = 0;
+    AkInt64 delayPhase = delayLine.delayPhase;
+    int segmentEnd = 0;
+    int segment = 0;
+    
+    // The resampler follows the Doppler factor of each segment; the head fading out stands still
+    const bool bResampler = interpType == INTERP_RESAMPLER;
+    const float* pResamplerKernels = nullptr;
+    const float* pFadeResamplerKernels = bResampler ? GetResamplerKernels(0) : nullptr;
+    
+    // Hold the writes back and store them a run at a time when no head reads that close
+    int stagedWriteLength = 0;
+    if (Ring::BATCHED_STORE)
     {
-        if (m_pDelayLines[chan].oversampleFactor > 1)
+        AkInt64 minDelayPhase = GetMinDelayPhase(delayPhase, blockParams, uValidFrames, OVERSAMPLE_NONE, Ring::DELAY_SPAN);
+        if (delayLine.crossfadeFrames > 0 && delayLine.fadePhase < minDelayPhase)
+            minDelayPhase = delayLine.fadePhase;
+        stagedWriteLength = GetStagedWriteLength(minDelayPhase);
+    }
+    float stagedWrites[STAGED_WRITE_LEN];
+    int numStagedWrites = 0;
+    
+    for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
+    {
+        if (frame == segmentEnd)
+        {
+            // Restart from the previous target exactly, so that rounding never accumulates
+            delayPhase = targetPhase;
+            segmentEnd = frame + segmentFrames < uValidFrames ? frame + segmentFrames : uValidFrames;
+            
+            float segmentDelayTime = pDelayCurve ? pDelayCurve[segment++] : currentDelayTime;
+            targetPhase = DelayTimeToPhase(segmentDelayTime, OVERSAMPLE_NONE, Ring::DELAY_SPAN);
+            phaseIncrement = (targetPhase - delayPhase) / (AkInt64)(segmentEnd - frame);
+            
+            if (bResampler)
+                pResamplerKernels = GetResamplerKernels(phaseIncrement);
+        }
+        
+        float delayedSample = ReadStandardTap(ring, delayLine.writePos, delayPhase, interpType, pResamplerKernels);
+        
+        if (delayLine.crossfadeFrames > 0)
+        {
+            // Equal power: sin and cos of the fade position
+            float t = 1.0f - (float)delayLine.crossfadeFrames / (float)delayLine.crossfadeLength;
+            int index = (int)(t * (float)(m_powerCompTableSize - 1)) & (m_powerCompTableSize - 1);
+            
+            float fadingSample = ReadStandardTap(ring, delayLine.writePos, delayLine.fadePhase, interpType, pFadeResamplerKernels);
+            delayedSample = delayedSample * m_crossfadeInTable[index] + fadingSample * m_crossfadeOutTable[index];
+            --delayLine.crossfadeFrames;
+        }
+        
+        // Apply feedback
+        float feedbackSample = delayedSample * feedback;
+        if (feedbackFilter.bEnabled)
+            feedbackSample = ApplyFeedbackFilter(delayLine, feedbackFilter, feedbackSample);
+        
+        float inputWithFeedback = pChannel[frame] + feedbackSample;
+        if (stagedWriteLength > 0)
         {
-            m_pDelayLines[chan].writePos = (m_pDelayLines[chan].writePos + 
-                in_uFrames * m_pDelayLines[chan].oversampleFactor) & 
-                (m_pDelayLines[chan].effectiveBufferSize - 1);
+            stagedWrites[numStagedWrites++] = inputWithFeedback;
+            if (numStagedWrites == stagedWriteLength)
+            {
+                ring.WriteBlock((delayLine.writePos + 1 - numStagedWrites) & Ring::MASK, stagedWrites, numStagedWrites);
+                numStagedWrites = 0;
+            }
         }
         else
         {
-            m_pDelayLines[chan].writePos = (m_pDelayLines[chan].writePos + in_uFrames) & BIT_MASK;
+            ring.Write(delayLine.writePos, inputWithFeedback);
+        }
+        
+        delayLine.writePos = (delayLine.writePos + 1) & Ring::MASK;
+        
+        if (distanceFilter.bEnabled)
+            delayedSample = ApplyDistanceFilter(delayLine, distanceFilter, delayedSample);
+        
+        // Output with wet/dry mix
+        if (WET_ONLY)
+            pChannel[frame] = delayedSample;
+        else
+            pChannel[frame] = pChannel[frame] * (1.0f - wetDryMix) + delayedSample * wetDryMix;
+        
+        delayPhase += phaseIncrement;
+    }
+    
+    if (numStagedWrites > 0)
+        ring.WriteBlock((delayLine.writePos - numStagedWrites) & Ring::MASK, stagedWrites, numStagedWrites);
+    
+    delayLine.delayPhase = targetPhase;
+    delayLine.distanceGain = distanceFilter.targetGain;
+}
+
+template<typename Ring, bool WET_ONLY, bool POLYNOMIAL>
+void FlexibleDelayLinesFX::ProcessShortSteady(DelayLineChannel& delayLine, float* pChannel, AkUInt16 uValidFrames,
+    const DelayLineBlockParams& blockParams, DistanceFilter& distanceFilter)
+{
+    Ring ring(delayLine);
+    
+    int frame = 0;
+    for (; frame + SHORT_STEADY_BLOCK <= uValidFrames; frame += SHORT_STEADY_BLOCK)
+        ProcessShortSteadyFrames<Ring, WET_ONLY, POLYNOMIAL>(delayLine, ring, pChannel + frame, SHORT_STEADY_BLOCK, blockParams, distanceFilter);
+    if (frame < uValidFrames)
+        ProcessShortSteadyFrames<Ring, WET_ONLY, POLYNOMIAL>(delayLine, ring, pChannel + frame, uValidFrames - frame, blockParams, distanceFilter);
+    
+    delayLine.distanceGain = distanceFilter.targetGain;
+}
+
+template<typename Ring, bool WET_ONLY, bool POLYNOMIAL>
+inline void FlexibleDelayLinesFX::ProcessShortSteadyFrames(DelayLineChannel& delayLine, Ring& ring, float* pChannel, int count,
+    const DelayLineBlockParams& blockParams, DistanceFilter& distanceFilter)
+{
+    const int wholeSampleDelay = (int)(delayLine.delayPhase >> DELAY_PHASE_SHIFT);
+    const float subSampleDelay = (float)(delayLine.delayPhase & DELAY_PHASE_FRAC_MASK) * DELAY_PHASE_FRAC_SCALE;
+    const int readPos = delayLine.writePos - wholeSampleDelay;
+    
+    // The same interpolation as ReadStandardTap, from a fixed distance behind the head
+    float delayed[SHORT_STEADY_BLOCK];
+    for (int i = 0; i < count; ++i)
+    {
+        if (POLYNOMIAL)
+            delayed[i] = InterpolatePolynomial4Point(ring, readPos + i - 1, 1.0f - subSampleDelay);
+        else
+            delayed[i] = InterpolateLinear(ring.Read(readPos + i), ring.Read(readPos + i - 1), subSampleDelay);
+    }
+    
+    float writes[SHORT_STEADY_BLOCK];
+    for (int i = 0; i < count; ++i)
+    {
+        float feedbackSample = delayed[i] * blockParams.feedback;
+        if (blockParams.feedbackFilter.bEnabled)
+            feedbackSample = ApplyFeedbackFilter(delayLine, blockParams.feedbackFilter, feedbackSample);
+        writes[i] = pChannel[i] + feedbackSample;
+    }
+    
+    if (Ring::BATCHED_STORE)
+    {
+        ring.WriteBlock(delayLine.writePos, writes, count);
+    }
+    else
+    {
+        for (int i = 0; i < count; ++i)
+            ring.Write((delayLine.writePos + i) & Ring::MASK, writes[i]);
+    }
+    delayLine.writePos = (delayLine.writePos + count) & Ring::MASK;
+    
+    for (int i = 0; i < count; ++i)
+    {
+        float delayedSample = delayed[i];
+        if (distanceFilter.bEnabled)
+            delayedSample = ApplyDistanceFilter(delayLine, distanceFilter, delayedSample);
+        
+        if (WET_ONLY)
+            pChannel[i] = delayedSample;
+        else
+            pChannel[i] = pChannel[i] * (1.0f - blockParams.wetDryMix) + delayedSample * blockParams.wetDryMix;
+    }
+}
+
+template<typename Ring, bool WET_ONLY>
+void FlexibleDelayLinesFX::ProcessFDN(DelayLineObject& object, AkAudioBuffer* io_pBuffer, const DelayLineBlockParams& blockParams)
+{
+    const AkUInt16 uValidFrames = io_pBuffer->uValidFrames;
+    const int numLines = (int)object.uNumChannels;
+    const float currentDelayTime = blockParams.delayTime;
+    const float* pDelayCurve = blockParams.pDelayCurve;
+    const float wetDryMix = blockParams.wetDryMix;
+    const float feedback = blockParams.feedback;
+    const InterpolationType interpType = blockParams.interpType;
+    
+    // Both matrices are orthogonal, so the loop gain stays the Feedback parameter
+    const bool bHadamard = m_feedbackMatrix == FEEDBACK_MATRIX_HADAMARD && (numLines & (numLines - 1)) == 0;
+    const float householderScale = 2.0f / (float)numLines;
+    const float hadamardScale = 1.0f / sqrtf((float)numLines);
+    const FeedbackFilter feedbackFilter = blockParams.feedbackFilter;
+    
+    DelayLineChannel* pDelayLines = object.pDelayLines;
+    float* pChannels[FDN_MAX_LINES];
+    float lineScale[FDN_MAX_LINES];
+    AkInt64 targetPhase[FDN_MAX_LINES];
+    AkInt64 phaseIncrement[FDN_MAX_LINES];
+    AkInt64 delayPhase[FDN_MAX_LINES];
+    const float* pResamplerKernels[FDN_MAX_LINES] = {};
+    float delayed[FDN_MAX_LINES];
+    float mixed[FDN_MAX_LINES];
+    DistanceFilter distanceFilters[FDN_MAX_LINES];
+    
+    for (int line = 0; line < numLines; ++line)
+    {
+        distanceFilters[line] = ComputeDistanceFilter(pDelayLines[line], blockParams, m_fSampleRate, uValidFrames);
+        pChannels[line] = io_pBuffer->GetChannel(line);
+        lineScale[line] = 1.0f + blockParams.delaySpread * m_fdnLineSpread[line];
+        targetPhase[line] = pDelayLines[line].delayPhase;
+        delayPhase[line] = pDelayLines[line].delayPhase;
+        phaseIncrement[line] = 0;
+        
+        // The lines feed each other: one missing page and the whole network passes the dry signal
+        if (Ring::IS_PAGED
+            && !UpdateDelayPages(pDelayLines[line],
+                DelayTimeToPhase(blockParams.maxDelayTime * lineScale[line], OVERSAMPLE_NONE, Ring::DELAY_SPAN), uValidFrames))
+        {
+            return;
+        }
+    }
+    
+    const int segmentFrames = pDelayCurve ? blockParams.curveSegmentFrames : uValidFrames;
+    int segmentEnd = 0;
+    int segment = 0;
+    
+    for (AkUInt16 frame = 0; frame < uValidFrames; ++frame)
+    {
+        if (frame == segmentEnd)
+        {
+            segmentEnd = frame + segmentFrames < uValidFrames ? frame + segmentFrames : uValidFrames;
+            float segmentDelayTime = pDelayCurve ? pDelayCurve[segment++] : currentDelayTime;
+            
+            for (int line = 0; line < numLines; ++line)
+            {
+                delayPhase[line] = targetPhase[line];
+                targetPhase[line] = DelayTimeToPhase(segmentDelayTime * lineScale[line], OVERSAMPLE_NONE, Ring::DELAY_SPAN);
+                phaseIncrement[line] = (targetPhase[line] - delayPhase[line]) / (AkInt64)(segmentEnd - frame);
+                
+                if (interpType == INTERP_RESAMPLER)
+                    pResamplerKernels[line] = GetResamplerKernels(phaseIncrement[line]);
+            }
+        }
+        
+        for (int line = 0; line < numLines; ++line)
+            delayed[line] = ReadStandardTap(Ring(pDelayLines[line]), pDelayLines[line].writePos, delayPhase[line], interpType, pResamplerKernels[line]);
+        
+        // Mix the delayed lines
+        if (bHadamard)
+        {
+            memcpy(mixed, delayed, sizeof(float) * numLines);
+            MixHadamard(mixed, numLines, hadamardScale);
+        }
+        else
+        {
+            MixHouseholder(delayed, mixed, numLines, householderScale);
+        }
+        
+        for (int line = 0; line < numLines; ++line)
+        {
+            DelayLineChannel& delayLine = pDelayLines[line];
+            float input = pChannels[line][frame];
+            
+            float feedbackSample = mixed[line] * feedback;
+            if (feedbackFilter.bEnabled)
+                feedbackSample = ApplyFeedbackFilter(delayLine, feedbackFilter, feedbackSample);
+            
+            Ring(delayLine).Write(delayLine.writePos, input + feedbackSample);
+            delayLine.writePos = (delayLine.writePos + 1) & Ring::MASK;
+            
+            float output = delayed[line];
+            if (distanceFilters[line].bEnabled)
+                output = ApplyDistanceFilter(delayLine, distanceFilters[line], output);
+            
+            if (WET_ONLY)
+                pChannels[line][frame] = output;
+            else
+                pChannels[line][frame] = input * (1.0f - wetDryMix) + output * wetDryMix;
+            delayPhase[line] += phaseIncrement[line];
+        }
+    }
+    
+    for (int line = 0; line < numLines; ++line)
+    {
+        pDelayLines[line].delayPhase = targetPhase[line];
+        pDelayLines[line].distanceGain = distanceFilters[line].targetGain;
+    }
+}
+
+template<bool WET_ONLY>
+void FlexibleDelayLinesFX::ProcessDecimated(DelayLineChannel& delayLine, float* pChannel, AkUInt16 uValidFrames, const DelayLineBlockParams& blockParams)
+{
+    const int decimationFactor = m_decimationFactor;
+    const int firLength = m_decimationFIRLength;
+    const int tapsPerPhase = m_interpolationTapsPerPhase;
+    const float wetDryMix = blockParams.wetDryMix;
+    
+    // The ring runs at the reduced rate and only the delayed signal comes back out of it
+    // A delay curve is followed at buffer rate here, its control points do not line up with the chunks
+    DelayLineBlockParams loopParams = blockParams;
+    loopParams.delayTime = blockParams.delayTime / (float)decimationFactor;
+    loopParams.maxDelayTime = blockParams.maxDelayTime / (float)decimationFactor;
+    loopParams.pDelayCurve = nullptr;
+    loopParams.distanceEffects = DISTANCE_EFFECTS_NONE;
+    
+    // Distance effects run at the full rate, on the way out
+    DistanceFilter distanceFilter = ComputeDistanceFilter(delayLine, blockParams, m_fSampleRate, uValidFrames);
+    
+    float* decimationHistory = delayLine.decimationHistory;
+    float* interpolationHistory = delayLine.interpolationHistory;
+    
+    AkUInt16 chunkStart = 0;
+    while (chunkStart < uValidFrames)
+    {
+        // Filter the input and keep one sample in decimationFactor, until the scratch is full
+        const int chunkStartPhase = delayLine.decimationPhase;
+        int numDecimated = 0;
+        AkUInt16 chunkEnd = chunkStart;
+        
+        while (chunkEnd < uValidFrames && numDecimated < DECIMATION_CHUNK_LEN)
+        {
+            int pos = delayLine.decimationPos;
+            decimationHistory[pos] = pChannel[chunkEnd];
+            decimationHistory[pos + DECIMATION_HISTORY_LEN] = pChannel[chunkEnd];
+            delayLine.decimationPos = (pos + 1) & (DECIMATION_HISTORY_LEN - 1);
+            
+            if (++delayLine.decimationPhase == decimationFactor)
+            {
+                delayLine.decimationPhase = 0;
+                
+                const float* pNewest = decimationHistory + pos + DECIMATION_HISTORY_LEN;
+                float sum = 0.0f;
+                for (int tap = 0; tap < firLength; ++tap)
+                    sum += m_pDecimationFIR[tap] * pNewest[-tap];
+                
+                m_decimatedScratch[numDecimated++] = sum;
+            }
+            
+            ++chunkEnd;
+        }
+        
+        if (numDecimated > 0)
+            (this->*m_mixKernels[MIX_WET_ONLY].standard)(delayLine, m_decimatedScratch, (AkUInt16)numDecimated, loopParams);
+        
+        // Interpolate the delayed signal back up, replaying the decimation phase frame by frame
+        int phase = chunkStartPhase;
+        int numInterpolated = 0;
+        
+        for (AkUInt16 frame = chunkStart; frame < chunkEnd; ++frame)
+        {
+            if (++phase == decimationFactor)
+            {
+                phase = 0;
+                
+                int pos = delayLine.interpolationPos;
+                interpolationHistory[pos] = m_decimatedScratch[numInterpolated];
+                interpolationHistory[pos + INTERPOLATION_HISTORY_LEN] = m_decimatedScratch[numInterpolated];
+                delayLine.interpolationPos = (pos + 1) & (INTERPOLATION_HISTORY_LEN - 1);
+                ++numInterpolated;
+            }
+            
+            const float* pNewest = interpolationHistory + INTERPOLATION_HISTORY_LEN
+                + ((delayLine.interpolationPos - 1) & (INTERPOLATION_HISTORY_LEN - 1));
+            const float* pBranch = m_pInterpolationPolyphase + phase * tapsPerPhase;
+            
+            float delayedSample = 0.0f;
+            for (int tap = 0; tap < tapsPerPhase; ++tap)
+                delayedSample += pBranch[tap] * pNewest[-tap];
+            
+            if (distanceFilter.bEnabled)
+                delayedSample = ApplyDistanceFilter(delayLine, distanceFilter, delayedSample);
+            
+            // Mix wet/dry
+            if (WET_ONLY)
+                pChannel[frame] = delayedSample;
+            else
+                pChannel[frame] = pChannel[frame] * (1.0f - wetDryMix) + delayedSample * wetDryMix;
+        }
+        
+        chunkStart = chunkEnd;
+    }
+    
+    delayLine.distanceGain = distanceFilter.targetGain;
+}
+
+bool FlexibleDelayLinesFX::UpdateDelayPages(DelayLineChannel& delayLine, AkInt64 targetPhase, AkUInt16 uValidFrames)
+{
+    FlexibleDelayLinesFXMemoryPool& pool = FlexibleDelayLinesFXMemoryPool::Get();
+    const AkUInt32 pageBytes = m_storageBytesPerSample * DELAY_PAGE_LEN;
+    
+    // Oldest sample the interpolators can touch this buffer
+    AkInt64 maxPhase = targetPhase > delayLine.delayPhase ? targetPhase : delayLine.delayPhase;
+    int maxWholeDelay = (int)(maxPhase >> DELAY_PHASE_SHIFT) + INTERPOLATOR_REACH;
+    
+    int writePage = delayLine.writePos >> DELAY_PAGE_SHIFT;
+    int oldestPage = ((delayLine.writePos - maxWholeDelay) & PAGED_BIT_MASK) >> DELAY_PAGE_SHIFT;
+    int keepAge = (writePage - oldestPage) & (DELAY_PAGE_COUNT - 1);
+    
+    // Release pages from the tail once the read head can no longer reach them
+    while (delayLine.numCommittedPages > 0
+        && ((writePage - delayLine.tailPage) & (DELAY_PAGE_COUNT - 1)) > keepAge)
+    {
+        if (delayLine.pages[delayLine.tailPage] != s_pSilentPage)
+            pool.Release(delayLine.pages[delayLine.tailPage], pageBytes);
+        delayLine.pages[delayLine.tailPage] = s_pSilentPage;
+        delayLine.tailPage = (delayLine.tailPage + 1) & (DELAY_PAGE_COUNT - 1);
+        --delayLine.numCommittedPages;
+    }
+    
+    // Commit the pages this buffer writes into
+    return CommitDelayPages(delayLine, delayLine.writePos, uValidFrames);
+}
+
+bool FlexibleDelayLinesFX::CommitDelayPages(DelayLineChannel& delayLine, int firstPos, int numFrames)
+{
+    FlexibleDelayLinesFXMemoryPool& pool = FlexibleDelayLinesFXMemoryPool::Get();
+    const AkUInt32 pageBytes = m_storageBytesPerSample * DELAY_PAGE_LEN;
+    
+    int firstPage = (firstPos & PAGED_BIT_MASK) >> DELAY_PAGE_SHIFT;
+    int lastPage = ((firstPos + numFrames - 1) & PAGED_BIT_MASK) >> DELAY_PAGE_SHIFT;
+    for (int page = firstPage; ; page = (page + 1) & (DELAY_PAGE_COUNT - 1))
+    {
+        if (delayLine.pages[page] == s_pSilentPage)
+        {
+            AkUInt8* pPage = (AkUInt8*)pool.Acquire(pageBytes);
+            if (pPage == nullptr)
+                return false;
+            
+            memset(pPage, 0, pageBytes);
+            delayLine.pages[page] = pPage;
+            
+            // Past the end of the run, extend it over any silent pages on the way (a snapshot
+            // restore fills those in later); inside it, this fills one of them
+            const int runOffset = (page - delayLine.tailPage) & (DELAY_PAGE_COUNT - 1);
+            if (delayLine.numCommittedPages == 0)
+            {
+                delayLine.tailPage = page;
+                delayLine.numCommittedPages = 1;
+            }
+            else if (runOffset >= delayLine.numCommittedPages)
+            {
+                delayLine.numCommittedPages = runOffset + 1;
+            }
+        }
+        
+        if (page == lastPage)
+            break;
+    }
+    
+    return true;
+}
+
+void FlexibleDelayLinesFX::ReleaseDelayPages(DelayLineChannel& delayLine)
+{
+    FlexibleDelayLinesFXMemoryPool& pool = FlexibleDelayLinesFXMemoryPool::Get();
+    const AkUInt32 pageBytes = m_storageBytesPerSample * DELAY_PAGE_LEN;
+    
+    for (; delayLine.numCommittedPages > 0; --delayLine.numCommittedPages)
+    {
+        if (delayLine.pages[delayLine.tailPage] != s_pSilentPage)
+            pool.Release(delayLine.pages[delayLine.tailPage], pageBytes);
+        delayLine.pages[delayLine.tailPage] = s_pSilentPage;
+        delayLine.tailPage = (delayLine.tailPage + 1) & (DELAY_PAGE_COUNT - 1);
+    }
+    
+    delayLine.tailPage = 0;
+}
+
+void FlexibleDelayLinesFX::ReserveDelayMemory(DelayLineObject& object)
+{
+    FlexibleDelayLinesFXMemoryPool& pool = FlexibleDelayLinesFXMemoryPool::Get();
+    
+    bool bReserved = true;
+    if (m_delayMemoryMode == DELAY_MEMORY_PAGED)
+    {
+        // The pages under the longest delay the object can reach, the one being written and the one
+        // being read from
+        const AkUInt32 numPages = (AkUInt32)GetMaxDelaySamples() / DELAY_PAGE_LEN + 2;
+        object.uReservedBlocks = object.uNumChannels * numPages;
+        bReserved = pool.Reserve(m_storageBytesPerSample * DELAY_PAGE_LEN, object.uReservedBlocks);
+    }
+    else if (m_delayMemoryMode == DELAY_MEMORY_POOLED)
+    {
+        object.uReservedBlocks = object.uNumChannels;
+        bReserved = pool.Reserve(GetDelayRingBytes(m_storageFormat, OVERSAMPLE_NONE), object.uReservedBlocks);
+        if (m_oversampleFactor > OVERSAMPLE_NONE)
+        {
+            object.uReservedOversampledBlocks = object.uNumChannels;
+            bReserved = pool.Reserve(GetDelayRingBytes(m_storageFormat, m_oversampleFactor), object.uReservedOversampledBlocks)
+                && bReserved;
+        }
+    }
+    
+    if (!bReserved && !m_bPoolShortfallReported)
+        ReportPoolShortfall();
+}
+
+void FlexibleDelayLinesFX::UnreserveDelayMemory(DelayLineObject& object)
+{
+    FlexibleDelayLinesFXMemoryPool& pool = FlexibleDelayLinesFXMemoryPool::Get();
+    
+    if (m_delayMemoryMode == DELAY_MEMORY_PAGED)
+    {
+        pool.Unreserve(m_storageBytesPerSample * DELAY_PAGE_LEN, object.uReservedBlocks);
+    }
+    else if (m_delayMemoryMode == DELAY_MEMORY_POOLED)
+    {
+        pool.Unreserve(GetDelayRingBytes(m_storageFormat, OVERSAMPLE_NONE), object.uReservedBlocks);
+        pool.Unreserve(GetDelayRingBytes(m_storageFormat, m_oversampleFactor), object.uReservedOversampledBlocks);
+    }
+    
+    object.uReservedBlocks = 0;
+    object.uReservedOversampledBlocks = 0;
+}
+
+float FlexibleDelayLinesFX::GetMaxDelaySamples() const
+{
+    // Without Max Delay Time, an RTPC or the engine distance can take the delay anywhere in the
+    // span, and Distance hands over to Delay Time whenever it drops to 0
+    const float delaySpan = (float)(m_delayMemoryMode == DELAY_MEMORY_PAGED ? PAGED_DELAY_SPAN : MAX_BUFFER_LEN);
+    
+    float delaySamples = delaySpan;
+    if (m_params.NonRTPC.maxDelayTime > 0)
+        delaySamples = (float)m_params.NonRTPC.maxDelayTime * 0.001f * m_fSampleRate;
+    
+    return delaySamples < delaySpan ? delaySamples : delaySpan;
+}
+
+bool FlexibleDelayLinesFX::ActivateDelayMemory(DelayLineObject& object)
+{
+    // Paged rings commit their pages as they write
+    if (m_delayMemoryMode == DELAY_MEMORY_POOLED)
+    {
+        FlexibleDelayLinesFXMemoryPool& pool = FlexibleDelayLinesFXMemoryPool::Get();
+        const AkUInt32 ringBytes = GetDelayRingBytes(m_storageFormat, OVERSAMPLE_NONE);
+        
+        // Every channel gets its rings or none does
+        for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+        {
+            DelayLineChannel& delayLine = object.pDelayLines[chan];
+            const AkUInt32 oversampledBytes = GetDelayRingBytes(m_storageFormat, delayLine.oversampleFactor);
+            
+            delayLine.buffer = (AkUInt8*)pool.Acquire(ringBytes);
+            if (delayLine.oversampleFactor > OVERSAMPLE_NONE && delayLine.buffer != nullptr)
+                delayLine.oversampledBuffer = (AkUInt8*)pool.Acquire(oversampledBytes);
+            
+            if (delayLine.buffer == nullptr
+                || (delayLine.oversampleFactor > OVERSAMPLE_NONE && delayLine.oversampledBuffer == nullptr))
+            {
+                DeactivateDelayMemory(object);
+                return false;
+            }
+            
+            // Whatever the last user left in the rings stays there, see FillingRing
+            delayLine.writePos = 0;
+            delayLine.firstWritePos = 0;
+        }
+    }
+    
+    object.bDelayMemoryActive = true;
+    object.uQuietFrames = 0;
+    return true;
+}
+
+void FlexibleDelayLinesFX::DeactivateDelayMemory(DelayLineObject& object)
+{
+    FlexibleDelayLinesFXMemoryPool& pool = FlexibleDelayLinesFXMemoryPool::Get();
+    const AkUInt32 ringBytes = GetDelayRingBytes(m_storageFormat, OVERSAMPLE_NONE);
+    
+    for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+    {
+        DelayLineChannel& delayLine = object.pDelayLines[chan];
+        
+        if (m_delayMemoryMode == DELAY_MEMORY_PAGED)
+        {
+            ReleaseDelayPages(delayLine);
+            continue;
+        }
+        
+        pool.Release(delayLine.buffer, ringBytes);
+        pool.Release(delayLine.oversampledBuffer, GetDelayRingBytes(m_storageFormat, delayLine.oversampleFactor));
+        delayLine.buffer = nullptr;
+        delayLine.oversampledBuffer = nullptr;
+    }
+    
+    object.bDelayMemoryActive = false;
+}
+
+void FlexibleDelayLinesFX::ClearUnwrittenFrames(DelayLineChannel& delayLine, int numFrames)
+{
+    const int bufferMask = delayLine.effectiveBufferSize - 1;
+    const int numUnwritten = delayLine.effectiveBufferSize - ((delayLine.writePos - delayLine.firstWritePos) & bufferMask);
+    const bool bFull = numFrames >= numUnwritten;
+    if (bFull)
+        numFrames = numUnwritten;
+    
+    // The low band's base-rate ring fills up in step with the oversampled one
+    const int oversampleFactor = delayLine.oversampleFactor;
+    if (oversampleFactor > OVERSAMPLE_NONE)
+    {
+        ClearRingFrames(delayLine.oversampledBuffer, bufferMask, delayLine.writePos, numFrames);
+        if (m_bBandSplit)
+            ClearRingFrames(delayLine.buffer, BIT_MASK, delayLine.writePos / oversampleFactor, numFrames / oversampleFactor);
+    }
+    else
+    {
+        ClearRingFrames(delayLine.buffer, bufferMask, delayLine.writePos, numFrames);
+    }
+    
+    if (bFull)
+        delayLine.firstWritePos = -1;
+}
+
+void FlexibleDelayLinesFX::ClearRingFrames(AkUInt8* pRing, int mask, int firstPos, int numFrames) const
+{
+    const int first = numFrames < mask + 1 - firstPos ? numFrames : mask + 1 - firstPos;
+    memset(pRing + firstPos * m_storageBytesPerSample, 0, first * m_storageBytesPerSample);
+    if (first < numFrames)
+        memset(pRing, 0, (numFrames - first) * m_storageBytesPerSample);
+}
+
+bool FlexibleDelayLinesFX::HasSignal(AkAudioBuffer* io_pBuffer) const
+{
+    for (AkUInt32 chan = 0; chan < io_pBuffer->NumChannels(); ++chan)
+    {
+        const float* pChannel = io_pBuffer->GetChannel(chan);
+        for (AkUInt16 frame = 0; frame < io_pBuffer->uValidFrames; ++frame)
+        {
+            if (fabsf(pChannel[frame]) > SILENCE_THRESHOLD)
+                return true;
+        }
+    }
+    return false;
+}
+
+float FlexibleDelayLinesFX::GetTailFrames(float delayTime, float feedback) const
+{
+    // Each trip around the loop scales the echo by the feedback gain; count the trips
+    // until a full-scale input falls below the silence threshold, plus the first one
+    float loopGain = fabsf(feedback);
+    if (loopGain >= 1.0f)
+        return FLT_MAX;
+    
+    float numEchoes = 1.0f;
+    if (loopGain > 0.0f)
+        numEchoes += logf(SILENCE_THRESHOLD) / logf(loopGain);
+    
+    return delayTime * m_fSampleRate * numEchoes;
+}
+
+int FlexibleDelayLinesFX::GetSnapshotFrames(const DelayLineChannel& delayLine) const
+{
+    // Same reach as the page release: the delay plus the interpolators
+    const int ringLength = (m_delayMemoryMode == DELAY_MEMORY_PAGED ? PAGED_BIT_MASK : BIT_MASK) + 1;
+    int liveFrames = (int)(delayLine.delayPhase >> DELAY_PHASE_SHIFT) + INTERPOLATOR_REACH;
+    return liveFrames < ringLength ? liveFrames : ringLength;
+}
+
+bool FlexibleDelayLinesFX::SaveSnapshot(DelayLineObject& object)
+{
+    // Only the base-rate ring goes in the snapshot, which is not what an oversampled or decimated
+    // loop reads: those keep their rings while virtual (ResolveEffectiveSettings turns it off too)
+    if (m_oversampleFactor > OVERSAMPLE_NONE || m_decimationFactor > DECIMATE_NONE)
+        return false;
+    
+    // The storage was sized for the longest delay the object can reach; a longer tail stays in the rings
+    if (object.pSnapshot == nullptr)
+        return false;
+    for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+    {
+        if (GetSnapshotFrames(object.pDelayLines[chan]) > (int)object.uSnapshotFrames)
+            return false;
+    }
+    
+    DelayLineChannelSnapshot* pHeaders = (DelayLineChannelSnapshot*)object.pSnapshot;
+    for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+    {
+        DelayLineChannel& delayLine = object.pDelayLines[chan];
+        DelayLineChannelSnapshot& header = pHeaders[chan];
+        
+        header.delayPhase = delayLine.delayPhase;
+        header.lastDelayTime = delayLine.lastDelayTime;
+        header.dampingLowpassState = delayLine.dampingLowpassState;
+        header.dampingHighpassState = delayLine.dampingHighpassState;
+        header.dcBlockerInput = delayLine.dcBlockerInput;
+        header.dcBlockerOutput = delayLine.dcBlockerOutput;
+        header.airAbsorptionState = delayLine.airAbsorptionState;
+        header.distanceGain = delayLine.distanceGain;
+        header.liveFrames = GetSnapshotFrames(delayLine);
+        
+        (this->*m_encodeSnapshotFunction)(delayLine, GetSnapshotSamples(object, chan), header.liveFrames);
+    }
+    
+    object.bSnapshotHeld = true;
+    return true;
+}
+
+void FlexibleDelayLinesFX::BeginSnapshotRestore(DelayLineObject& object)
+{
+    const DelayLineChannelSnapshot* pHeaders = (const DelayLineChannelSnapshot*)object.pSnapshot;
+    
+    for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+    {
+        DelayLineChannel& delayLine = object.pDelayLines[chan];
+        const DelayLineChannelSnapshot& header = pHeaders[chan];
+        
+        delayLine.delayPhase = header.delayPhase;
+        delayLine.lastDelayTime = header.lastDelayTime;
+        delayLine.dampingLowpassState = header.dampingLowpassState;
+        delayLine.dampingHighpassState = header.dampingHighpassState;
+        delayLine.dcBlockerInput = header.dcBlockerInput;
+        delayLine.dcBlockerOutput = header.dcBlockerOutput;
+        delayLine.airAbsorptionState = header.airAbsorptionState;
+        delayLine.distanceGain = header.distanceGain;
+        
+        // The samples land just behind the write head, wherever it is now; until RestoreSnapshot
+        // gets to them they read as silence
+        delayLine.restorePos = (delayLine.writePos - header.liveFrames) & (delayLine.effectiveBufferSize - 1);
+        delayLine.numRestoreFrames = header.liveFrames;
+        
+        // A pooled ring holds audio from the oldest restored sample on
+        if (m_delayMemoryMode == DELAY_MEMORY_POOLED)
+            delayLine.firstWritePos = header.liveFrames < BIT_MASK + 1 ? delayLine.restorePos : -1;
+    }
+}
+
+void FlexibleDelayLinesFX::RestoreSnapshot(DelayLineObject& object, int numFrames)
+{
+    const int bytesPerSample = m_virtualSnapshot == VIRTUAL_SNAPSHOT_HALF
+        ? DelayStorageHalf::BYTES_PER_SAMPLE : DelayStorageFloat32::BYTES_PER_SAMPLE;
+    
+    const DelayLineChannelSnapshot* pHeaders = (const DelayLineChannelSnapshot*)object.pSnapshot;
+    
+    bool bRestored = true;
+    for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+    {
+        DelayLineChannel& delayLine = object.pDelayLines[chan];
+        if (delayLine.numRestoreFrames == 0)
+            continue;
+        
+        const int bufferMask = delayLine.effectiveBufferSize - 1;
+        
+        // Ages, from the write head as it is now, of the oldest sample the heads start from and of
+        // the youngest they reach by the end of the buffer
+        AkInt64 oldestPhase = delayLine.delayPhase;
+        AkInt64 youngestPhase = delayLine.delayPhase;
+        if (delayLine.crossfadeFrames > 0)
+        {
+            if (delayLine.fadePhase > oldestPhase)
+                oldestPhase = delayLine.fadePhase;
+            else
+                youngestPhase = delayLine.fadePhase;
+        }
+        const int oldestAge = (int)(oldestPhase >> DELAY_PHASE_SHIFT) + INTERPOLATOR_REACH;
+        const int youngestAge = (int)(youngestPhase >> DELAY_PHASE_SHIFT) - INTERPOLATOR_REACH - numFrames;
+        
+        // The delay shortened past what is back: the tail older than the heads is dropped
+        int restoreAge = ((delayLine.writePos - delayLine.restorePos - 1) & bufferMask) + 1;
+        if (restoreAge > oldestAge)
+        {
+            const int numDropped = restoreAge - oldestAge < delayLine.numRestoreFrames
+                ? restoreAge - oldestAge : delayLine.numRestoreFrames;
+            delayLine.restorePos = (delayLine.restorePos + numDropped) & bufferMask;
+            delayLine.numRestoreFrames -= numDropped;
+            restoreAge -= numDropped;
+            
+            if (m_delayMemoryMode == DELAY_MEMORY_POOLED)
+                delayLine.firstWritePos = delayLine.restorePos;
+        }
+        
+        // Everything the heads reach this buffer and a staged run more, and never less than
+        // SNAPSHOT_RESTORE_RATE samples per frame so the restore outruns the heads and the writes
+        int count = restoreAge - youngestAge + STAGED_WRITE_LEN;
+        if (count < numFrames * SNAPSHOT_RESTORE_RATE)
+            count = numFrames * SNAPSHOT_RESTORE_RATE;
+        if (count > delayLine.numRestoreFrames)
+            count = delayLine.numRestoreFrames;
+        if (count == 0)
+            continue;
+        
+        // Pages come from the pool as the restore reaches them
+        if (m_delayMemoryMode == DELAY_MEMORY_PAGED && !CommitDelayPages(delayLine, delayLine.restorePos, count))
+        {
+            delayLine.numRestoreFrames = 0;
+            continue;
+        }
+        
+        const int firstFrame = pHeaders[chan].liveFrames - delayLine.numRestoreFrames;
+        (this->*m_decodeSnapshotFunction)(delayLine, GetSnapshotSamples(object, chan) + firstFrame * bytesPerSample,
+            delayLine.restorePos, count);
+        
+        delayLine.restorePos = (delayLine.restorePos + count) & bufferMask;
+        delayLine.numRestoreFrames -= count;
+        if (delayLine.numRestoreFrames > 0)
+            bRestored = false;
+    }
+    
+    if (bRestored)
+        object.bSnapshotHeld = false;
+}
+
+void FlexibleDelayLinesFX::DiscardSnapshot(DelayLineObject& object)
+{
+    object.bSnapshotHeld = false;
+    for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+        object.pDelayLines[chan].numRestoreFrames = 0;
+}
+
+void FlexibleDelayLinesFX::AllocateSnapshot(DelayLineObject& object)
+{
+    const int bytesPerSample = m_virtualSnapshot == VIRTUAL_SNAPSHOT_HALF
+        ? DelayStorageHalf::BYTES_PER_SAMPLE : DelayStorageFloat32::BYTES_PER_SAMPLE;
+    
+    // Room for the tail at the longest delay the object can reach, see GetSnapshotFrames
+    const int ringLength = (m_delayMemoryMode == DELAY_MEMORY_PAGED ? PAGED_BIT_MASK : BIT_MASK) + 1;
+    int maxFrames = (int)GetMaxDelaySamples() + 1 + INTERPOLATOR_REACH;
+    if (maxFrames > ringLength)
+        maxFrames = ringLength;
+    
+    // One header per channel, then each channel's samples
+    const size_t snapshotSize = sizeof(DelayLineChannelSnapshot) * object.uNumChannels
+        + (size_t)object.uNumChannels * maxFrames * bytesPerSample;
+    
+    object.pSnapshot = (AkUInt8*)AK_PLUGIN_ALLOC(m_pAllocator, snapshotSize);
+    object.uSnapshotFrames = object.pSnapshot != nullptr ? (AkUInt32)maxFrames : 0;
+}
+
+void FlexibleDelayLinesFX::FreeSnapshot(DelayLineObject& object)
+{
+    if (object.pSnapshot != nullptr)
+    {
+        AK_PLUGIN_FREE(m_pAllocator, object.pSnapshot);
+        object.pSnapshot = nullptr;
+    }
+    
+    object.uSnapshotFrames = 0;
+    object.bSnapshotHeld = false;
+}
+
+AkUInt8* FlexibleDelayLinesFX::GetSnapshotSamples(const DelayLineObject& object, AkUInt32 chan) const
+{
+    const int bytesPerSample = m_virtualSnapshot == VIRTUAL_SNAPSHOT_HALF
+        ? DelayStorageHalf::BYTES_PER_SAMPLE : DelayStorageFloat32::BYTES_PER_SAMPLE;
+    
+    return object.pSnapshot + sizeof(DelayLineChannelSnapshot) * object.uNumChannels
+        + (size_t)chan * object.uSnapshotFrames * bytesPerSample;
+}
+
+template<typename Ring>
+void FlexibleDelayLinesFX::EncodeSnapshot(DelayLineChannel& delayLine, AkUInt8* pSamples, int liveFrames)
+{
+    const Ring ring(delayLine);
+    const int firstPos = delayLine.writePos - liveFrames;
+    
+    // A pooled ring still filling up holds nothing older than its first write
+    const int numWritten = Ring::IS_POOLED && ring.firstWritePos >= 0
+        ? (delayLine.writePos - ring.firstWritePos) & Ring::MASK : Ring::MASK + 1;
+    
+    float samples[STAGED_WRITE_LEN];
+    for (int start = 0; start < liveFrames; start += STAGED_WRITE_LEN)
+    {
+        const int count = liveFrames - start < STAGED_WRITE_LEN ? liveFrames - start : STAGED_WRITE_LEN;
+        for (int i = 0; i < count; ++i)
+            samples[i] = liveFrames - start - i <= numWritten ? ring.Read(firstPos + start + i) : 0.0f;
+        
+        if (m_virtualSnapshot == VIRTUAL_SNAPSHOT_HALF)
+            DelayStorageHalf::StoreBlock(pSamples, start, samples, count);
+        else
+            DelayStorageFloat32::StoreBlock(pSamples, start, samples, count);
+    }
+}
+
+template<typename Ring>
+void FlexibleDelayLinesFX::DecodeSnapshot(DelayLineChannel& delayLine, const AkUInt8* pSamples, int firstPos, int numFrames)
+{
+    Ring ring(delayLine);
+    
+    float samples[STAGED_WRITE_LEN];
+    for (int start = 0; start < numFrames; start += STAGED_WRITE_LEN)
+    {
+        const int count = numFrames - start < STAGED_WRITE_LEN ? numFrames - start : STAGED_WRITE_LEN;
+        for (int i = 0; i < count; ++i)
+        {
+            samples[i] = m_virtualSnapshot == VIRTUAL_SNAPSHOT_HALF
+                ? DelayStorageHalf::Load(pSamples, start + i)
+                : DelayStorageFloat32::Load(pSamples, start + i);
+        }
+        
+        ring.WriteBlock((firstPos + start) & Ring::MASK, samples, count);
+    }
+}
+
+void FlexibleDelayLinesFX::LoadDelayCurve(float currentDelayTime)
+{
+    const FlexibleDelayLinesDelayCurve& curve = m_params.DelayCurve;
+    
+    m_uDelayCurveVersion = m_params.uDelayCurveVersion;
+    m_delayCurveRTPCDelayTime = m_params.RTPC.fDelayTime;
+    m_delayCurveRTPCDistance = m_params.RTPC.fDistance;
+    m_delayCurveTime = 0.0;
+    m_delayCurveCursor = 0;
+    m_delayCurveNumPoints = 0;
+    
+    // Start from wherever the delay is now, unless the curve says otherwise
+    if (curve.points[0].fTime > 0.0f)
+    {
+        m_delayCurveTimes[0] = 0.0f;
+        m_delayCurveValues[0] = currentDelayTime;
+        m_delayCurveNumPoints = 1;
+    }
+    
+    for (AkUInt32 i = 0; i < curve.uNumPoints; ++i)
+    {
+        float value = curve.points[i].fValue;
+        if (curve.uValueType == DELAY_CURVE_DISTANCE)
+            value = DistanceToDelayTime(value);
+        
+        m_delayCurveTimes[m_delayCurveNumPoints] = curve.points[i].fTime;
+        m_delayCurveValues[m_delayCurveNumPoints] = value;
+        ++m_delayCurveNumPoints;
+    }
+}
+
+float FlexibleDelayLinesFX::EvaluateDelayCurve(double time)
+{
+    const int lastPoint = m_delayCurveNumPoints - 1;
+    if (time >= (double)m_delayCurveTimes[lastPoint])
+        return m_delayCurveValues[lastPoint];
+    if (time <= (double)m_delayCurveTimes[0])
+        return m_delayCurveValues[0];
+    
+    // Time only moves forward, so the search resumes where it stopped
+    while (m_delayCurveCursor < lastPoint - 1 && time >= (double)m_delayCurveTimes[m_delayCurveCursor + 1])
+        ++m_delayCurveCursor;
+    
+    const int i = m_delayCurveCursor;
+    const float t0 = m_delayCurveTimes[i];
+    const float t1 = m_delayCurveTimes[i + 1];
+    const float v0 = m_delayCurveValues[i];
+    const float v1 = m_delayCurveValues[i + 1];
+    const float span = t1 - t0;
+    
+    // Cubic Hermite segment with Catmull-Rom tangents for uneven spacing, one-sided at the ends
+    float slope0 = i > 0
+        ? (v1 - m_delayCurveValues[i - 1]) / (t1 - m_delayCurveTimes[i - 1])
+        : (v1 - v0) / span;
+    float slope1 = i + 2 <= lastPoint
+        ? (m_delayCurveValues[i + 2] - v0) / (m_delayCurveTimes[i + 2] - t0)
+        : (v1 - v0) / span;
+    
+    float s = (float)((time - (double)t0) / (double)span);
+    float s2 = s * s;
+    float s3 = s2 * s;
+    
+    return (2.0f * s3 - 3.0f * s2 + 1.0f) * v0
+         + (s3 - 2.0f * s2 + s) * span * slope0
+         + (3.0f * s2 - 2.0f * s3) * v1
+         + (s3 - s2) * span * slope1;
+}
+
+bool FlexibleDelayLinesFX::UpdateDelayCurve(AkUInt16 uValidFrames, DelayLineBlockParams& blockParams)
+{
+    if (m_params.uDelayCurveVersion != m_uDelayCurveVersion)
+        LoadDelayCurve(m_uNumObjects > 0 && m_pObjects[0].uNumChannels > 0
+            ? m_pObjects[0].pDelayLines[0].lastDelayTime : blockParams.delayTime);
+    
+    if (m_delayCurveNumPoints == 0)
+        return false;
+    
+    // The RTPCs moved since the curve arrived: they take over again
+    if (m_params.RTPC.fDelayTime != m_delayCurveRTPCDelayTime
+        || m_params.RTPC.fDistance != m_delayCurveRTPCDistance)
+    {
+        m_delayCurveNumPoints = 0;
+        return false;
+    }
+    
+    int segmentFrames = DELAY_CURVE_CONTROL_FRAMES;
+    while ((uValidFrames + segmentFrames - 1) / segmentFrames > DELAY_CURVE_MAX_SEGMENTS)
+        segmentFrames *= 2;
+    
+    const int numSegments = (uValidFrames + segmentFrames - 1) / segmentFrames;
+    const double secondsPerFrame = 1.0 / (double)m_fSampleRate;
+    
+    float maxDelayTime = 0.0f;
+    for (int segment = 0; segment < numSegments; ++segment)
+    {
+        int endFrame = (segment + 1) * segmentFrames;
+        if (endFrame > uValidFrames)
+            endFrame = uValidFrames;
+        
+        float delayTime = EvaluateDelayCurve(m_delayCurveTime + (double)endFrame * secondsPerFrame);
+        m_delayCurveSegments[segment] = delayTime;
+        if (delayTime > maxDelayTime)
+            maxDelayTime = delayTime;
+    }
+    
+    m_delayCurveTime += (double)uValidFrames * secondsPerFrame;
+    
+    blockParams.pDelayCurve = m_delayCurveSegments;
+    blockParams.curveSegmentFrames = segmentFrames;
+    blockParams.delayTime = m_delayCurveSegments[numSegments - 1];
+    blockParams.maxDelayTime = maxDelayTime;
+    return true;
+}
+
+bool FlexibleDelayLinesFX::AcquireParams()
+{
+    if (!m_pParams->ReadSnapshot(m_params, m_uParamsSequence, PARAMS_SNAPSHOT_MAX_ATTEMPTS))
+        return false;
+    
+    UpdateParamBlockParams();
+    return true;
+}
+
+void FlexibleDelayLinesFX::UpdateParamBlockParams()
+{
+    AK::AkFXParameterChangeHandler<NUM_PARAMS>& changes = m_params.changes;
+    const FlexibleDelayLinesRTPCParams& rtpc = m_params.RTPC;
+    const FlexibleDelayLinesNonRTPCParams& nonRTPC = m_params.NonRTPC;
+    DelayLineBlockParams& blockParams = m_paramBlockParams;
+    
+    // A positive Distance RTPC takes over from Delay Time; the engine distance overrides both per buffer
+    if (changes.HasChanged(PARAM_DISTANCE_ID) || changes.HasChanged(PARAM_DELAYTIME_ID))
+    {
+        blockParams.distance = rtpc.fDistance > 0.0f ? rtpc.fDistance : 0.0f;
+        blockParams.delayTime = rtpc.fDistance > 0.0f ? DistanceToDelayTime(rtpc.fDistance) : rtpc.fDelayTime;
+    }
+    
+    if (changes.HasChanged(PARAM_WETDRYMIX_ID))
+    {
+        blockParams.wetDryMix = rtpc.fWetDryMix;
+        m_pMixKernels = &m_mixKernels[rtpc.fWetDryMix == 1.0f ? MIX_WET_ONLY : MIX_WET_DRY];
+    }
+    if (changes.HasChanged(PARAM_FEEDBACK_ID))
+        blockParams.feedback = rtpc.fFeedback;
+    if (changes.HasChanged(PARAM_DELAYSPREAD_ID))
+        blockParams.delaySpread = rtpc.fDelaySpread < 0.0f ? 0.0f : (rtpc.fDelaySpread > 1.0f ? 1.0f : rtpc.fDelaySpread);
+    
+    if (changes.HasChanged(PARAM_DAMPINGLOWPASS_ID) || changes.HasChanged(PARAM_DAMPINGHIGHPASS_ID)
+        || changes.HasChanged(PARAM_DCBLOCKER_ID))
+    {
+        blockParams.feedbackFilter = ComputeFeedbackFilter(rtpc.fDampingLowpass, rtpc.fDampingHighpass,
+            nonRTPC.dcBlocker != 0, m_fLoopSampleRate);
+        blockParams.lowBandFeedbackFilter = ComputeFeedbackFilter(rtpc.fDampingLowpass, rtpc.fDampingHighpass,
+            nonRTPC.dcBlocker != 0, m_fSampleRate);
+    }
+    
+    if (changes.HasChanged(PARAM_REFERENCEDISTANCE_ID))
+        blockParams.referenceDistance = rtpc.fReferenceDistance;
+    if (changes.HasChanged(PARAM_DISTANCEEFFECTS_ID))
+        blockParams.distanceEffects = nonRTPC.distanceEffects;
+    if (changes.HasChanged(PARAM_JUMPTHRESHOLD_ID))
+        blockParams.jumpThreshold = rtpc.fJumpThreshold;
+    if (changes.HasChanged(PARAM_CROSSFADETIME_ID))
+        blockParams.crossfadeTime = rtpc.fCrossfadeTime * 0.001f;
+    
+    if (changes.HasChanged(PARAM_INTERPOLATIONTYPE_ID))
+    {
+        blockParams.interpType = (InterpolationType)nonRTPC.interpolationType;
+        if (blockParams.interpType == INTERP_RESAMPLER && m_pResamplerKernels == nullptr)
+            blockParams.interpType = INTERP_LINEAR;   // Switched to after Init, which designs the kernels
+    }
+    if (changes.HasChanged(PARAM_OVERSAMPLINGFACTOR_ID))
+        blockParams.oversampleFactor = nonRTPC.oversamplingFactor;
+    
+    changes.ResetAllParamChanges();
+}
+
+float FlexibleDelayLinesFX::DistanceToDelayTime(float distance) const
+{
+    return (distance * 2.0f) / SPEED_OF_SOUND;
+}
+
+bool FlexibleDelayLinesFX::GetEngineDistance(float& out_distance) const
+{
+    const AkUInt32 distanceSource = m_params.NonRTPC.distanceSource;
+    if ((distanceSource != DISTANCE_SOURCE_NEAREST_LISTENER && distanceSource != DISTANCE_SOURCE_LISTENER_INDEX)
+        || m_pContext == nullptr)
+        return false;
+    
+    const AkUInt32 uNumPairs = m_pContext->GetNumEmitterListenerPairs();
+    if (uNumPairs == 0)
+        return false;
+    
+    AkEmitterListenerPair pair;
+    if (distanceSource == DISTANCE_SOURCE_LISTENER_INDEX)
+    {
+        // An index past the last pair follows the last one rather than dropping back to the RTPC
+        AkUInt32 uIndex = m_params.NonRTPC.listenerIndex;
+        if (uIndex >= uNumPairs)
+            uIndex = uNumPairs - 1;
+        if (m_pContext->GetEmitterListenerPair(uIndex, pair) != AK_Success)
+            return false;
+        out_distance = pair.Distance();
+        return true;
+    }
+    
+    // Nearest listener: with multi-position emitters this is also the nearest position
+    bool bFound = false;
+    for (AkUInt32 i = 0; i < uNumPairs; ++i)
+    {
+        if (m_pContext->GetEmitterListenerPair(i, pair) != AK_Success)
+            continue;
+        if (!bFound || pair.Distance() < out_distance)
+        {
+            out_distance = pair.Distance();
+            bFound = true;
+        }
+    }
+    return bFound;
+}
+
+void FlexibleDelayLinesFX::Execute(const AkAudioObjects& io_objects)
+{
+#ifdef FLEXIBLEDELAYLINES_PROFILE_EXECUTE
+    m_profiler.Begin();
+#endif
+    
+#ifdef FLEXIBLEDELAYLINES_SSE2
+    // The thread's floating-point mode belongs to the host: flush denormals for this call only
+    const unsigned int uSavedCSR = _mm_getcsr();
+    _mm_setcsr(uSavedCSR | MXCSR_FLUSH_DENORMALS);
+#endif
+    
+    // Object buffers all carry the same number of frames
+    const AkUInt16 uValidFrames = io_objects.uNumObjects > 0 ? io_objects.ppObjectBuffers[0]->uValidFrames : 0;
+    
+    // One consistent copy for the whole buffer; the parameter node may be written meanwhile
+    AcquireParams();
+    DelayLineBlockParams blockParams = m_paramBlockParams;
+    
+    float engineDistance;
+    if (GetEngineDistance(engineDistance))
+    {
+        blockParams.distance = engineDistance;
+        blockParams.delayTime = DistanceToDelayTime(engineDistance);
+    }
+    
+    blockParams.maxDelayTime = blockParams.delayTime;
+    blockParams.pDelayCurve = nullptr;
+    blockParams.curveSegmentFrames = 0;
+    bool bDelayCurve = uValidFrames > 0 && UpdateDelayCurve(uValidFrames, blockParams);
+    
+    const bool bObjectDistance = !bDelayCurve
+        && m_params.NonRTPC.distanceSource == DISTANCE_SOURCE_OBJECT_POSITION;
+    
+    for (AkUInt32 i = 0; i < m_uNumObjects; ++i)
+        m_pObjects[i].bInUse = false;
+    
+    for (AkUInt32 i = 0; i < io_objects.uNumObjects; ++i)
+    {
+        AkAudioBuffer* pBuffer = io_objects.ppObjectBuffers[i];
+        const AkAudioObject* pAudioObject = io_objects.ppObjects[i];
+        
+        // Out of memory: this object goes through dry
+        DelayLineObject* pObject = AcquireObject(pAudioObject->key, pBuffer->NumChannels());
+        if (pObject == nullptr)
+            continue;
+        pObject->bInUse = true;
+        
+        if (bObjectDistance)
+        {
+            // Object positions are relative to the listener
+            const AkVector& position = pAudioObject->positioning.threeD.xform.Position();
+            float distance = sqrtf(position.X * position.X + position.Y * position.Y + position.Z * position.Z);
+            
+            DelayLineBlockParams objectParams = blockParams;
+            objectParams.distance = distance;
+            objectParams.delayTime = DistanceToDelayTime(distance);
+            objectParams.maxDelayTime = objectParams.delayTime;
+            ProcessObject(*pObject, pBuffer, objectParams);
+        }
+        else
+        {
+            ProcessObject(*pObject, pBuffer, blockParams);
+        }
+    }
+    
+    // Objects missing from this call are gone; their memory goes back to the allocator or the pool
+    RemoveUnusedObjects();
+    
+#ifdef FLEXIBLEDELAYLINES_SSE2
+    _mm_setcsr(uSavedCSR);
+#endif
+    
+#ifdef FLEXIBLEDELAYLINES_PROFILE_EXECUTE
+    m_profiler.End(uValidFrames, m_fSampleRate);
+#endif
+}
+
+void FlexibleDelayLinesFX::ReportShortRingClamp(float maxDelayTime)
+{
+    m_bShortRingClampReported = true;
+    if (m_pContext == nullptr)
+        return;
+    
+    char message[192];
+    snprintf(message, sizeof(message),
+        "FlexibleDelayLines: a delay of %.0f ms is clamped to the %.0f ms of the short ring; raise Max Delay Time",
+        maxDelayTime * 1000.0f,
+        (float)SHORT_DELAY_SPAN * 1000.0f / m_fLoopSampleRate);
+    m_pContext->PostMonitorMessage(message, AK::Monitor::ErrorLevel_Error);
+}
+
+void FlexibleDelayLinesFX::ReportPoolShortfall()
+{
+    m_bPoolShortfallReported = true;
+    if (m_pContext == nullptr)
+        return;
+    
+    char message[192];
+    snprintf(message, sizeof(message),
+        "FlexibleDelayLines: the delay memory pool is at its %u MB budget; delays may drop out, set Max Delay Time",
+        (unsigned int)(FLEXIBLEDELAYLINES_POOL_BUDGET / (1024 * 1024)));
+    m_pContext->PostMonitorMessage(message, AK::Monitor::ErrorLevel_Error);
+}
+
+void FlexibleDelayLinesFX::ProcessObject(DelayLineObject& object, AkAudioBuffer* io_pBuffer, const DelayLineBlockParams& blockParams)
+{
+    const AkUInt16 uValidFrames = io_pBuffer->uValidFrames;
+    
+    if (m_delayMemoryMode != DELAY_MEMORY_CONTIGUOUS)
+    {
+        bool bInputActive = HasSignal(io_pBuffer);
+        
+        // Back from virtual: the tail starts going back into the rings before anything is written
+        if (object.bSnapshotHeld && !object.bDelayMemoryActive && ActivateDelayMemory(object))
+            BeginSnapshotRestore(object);
+        
+        // Nothing to delay yet, or the pool is full: the dry signal goes through untouched
+        if (!object.bDelayMemoryActive && (!bInputActive || !ActivateDelayMemory(object)))
+            return;
+        
+        object.uQuietFrames = bInputActive ? 0 : object.uQuietFrames + uValidFrames;
+        
+        // Clear what is left of a pooled ring before this buffer's writes come round to the first one
+        for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+        {
+            DelayLineChannel& delayLine = object.pDelayLines[chan];
+            if (delayLine.firstWritePos < 0)
+                continue;
+            
+            const int loopFrames = delayLine.oversampleFactor > OVERSAMPLE_NONE
+                ? uValidFrames * delayLine.oversampleFactor : uValidFrames / m_decimationFactor + 1;
+            const int numWritten = (delayLine.writePos - delayLine.firstWritePos) & (delayLine.effectiveBufferSize - 1);
+            if (delayLine.effectiveBufferSize - numWritten <= loopFrames)
+                ClearUnwrittenFrames(delayLine, loopFrames);
+        }
+        
+        // Ahead of what this buffer reads
+        if (object.bSnapshotHeld)
+            RestoreSnapshot(object, uValidFrames);
+    }
+    
+    const bool bNetwork = m_feedbackMatrix != FEEDBACK_MATRIX_NONE
+        && object.uNumChannels > 1 && object.uNumChannels <= FDN_MAX_LINES;
+    
+    if (m_bShortRing && !m_bShortRingClampReported)
+    {
+        // The longest FDN line is spread out to twice the delay
+        const float maxDelayTime = bNetwork ? blockParams.maxDelayTime * (1.0f + blockParams.delaySpread) : blockParams.maxDelayTime;
+        if (maxDelayTime * m_fLoopSampleRate > (float)SHORT_DELAY_SPAN)
+            ReportShortRingClamp(maxDelayTime);
+    }
+    
+    if (bNetwork)
+    {
+        (this->*m_pMixKernels->fdn)(object, io_pBuffer, blockParams);
+        
+        for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+            object.pDelayLines[chan].lastDelayTime = blockParams.delayTime;
+    }
+    else
+    {
+        // Process each channel
+        for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+        {
+            DelayLineChannel& delayLine = object.pDelayLines[chan];
+            float* pChannel = io_pBuffer->GetChannel(chan);
+        
+            // Choose processing path based on decimation and oversampling
+            if (m_decimationFactor > DECIMATE_NONE)
+            {
+                (this->*m_pMixKernels->decimated)(delayLine, pChannel, uValidFrames, blockParams);
+            }
+            else if (blockParams.oversampleFactor > 1 
+                && delayLine.oversampledBuffer
+                && delayLine.tempUpsampledInput 
+                && delayLine.tempDelayedOutput)
+            {
+                (this->*m_pMixKernels->oversampled)(delayLine, pChannel, uValidFrames, blockParams);
+            }
+            else
+            {
+                (this->*m_pMixKernels->standard)(delayLine, pChannel, uValidFrames, blockParams);
+            }
+        
+            delayLine.lastDelayTime = blockParams.delayTime;
+        }
+    }
+    
+    // Once the feedback tail has died out the ring only holds silence: give it back.
+    // In a network the energy keeps circulating through the longest line as well.
+    const float tailDelayTime = bNetwork ? blockParams.delayTime * (1.0f + blockParams.delaySpread) : blockParams.delayTime;
+    if (m_delayMemoryMode != DELAY_MEMORY_CONTIGUOUS
+        && (float)object.uQuietFrames > GetTailFrames(tailDelayTime, blockParams.feedback))
+    {
+        DiscardSnapshot(object);
+        DeactivateDelayMemory(object);
+    }
+}
+
+AKRESULT FlexibleDelayLinesFX::TimeSkip(const AkAudioObjects& io_objects, AkUInt32 in_uFrames)
+{
+    m_delayCurveTime += (double)in_uFrames / (double)m_fSampleRate;
+    
+    // Only objects we already track; new ones get their delay lines once they are processed
+    for (AkUInt32 i = 0; i < io_objects.uNumObjects; ++i)
+    {
+        DelayLineObject* pObject = FindObject(io_objects.ppObjects[i]->key);
+        if (pObject == nullptr && m_uNumObjects == 1 && m_pObjects[0].key == AK_INVALID_AUDIO_OBJECT_ID)
+            pObject = &m_pObjects[0];
+        if (pObject != nullptr)
+            SkipObject(*pObject, in_uFrames);
+    }
+    return AK_DataReady;
+}
+
+void FlexibleDelayLinesFX::SkipObject(DelayLineObject& object, AkUInt32 in_uFrames)
+{
+    // A tail still on its way back from the last snapshot goes into the rings in one go
+    if (object.bSnapshotHeld && object.bDelayMemoryActive)
+        RestoreSnapshot(object, PAGED_BUFFER_LEN);
+    
+    // Virtual voice: keep the tail aside and give the rings back until the voice returns
+    if (m_virtualSnapshot != VIRTUAL_SNAPSHOT_OFF
+        && object.bDelayMemoryActive
+        && !object.bSnapshotHeld
+        && SaveSnapshot(object))
+    {
+        DeactivateDelayMemory(object);
+    }
+    
+    DelayLineChannel* pDelayLines = object.pDelayLines;
+    for (AkUInt32 chan = 0; chan < object.uNumChannels; ++chan)
+    {
+        // The skip lands well past any jump crossfade
+        pDelayLines[chan].crossfadeFrames = 0;
+        
+        // Skipped frames were never written: a pooled ring still filling up reads them as silence
+        if (object.bDelayMemoryActive && pDelayLines[chan].firstWritePos >= 0)
+        {
+            ClearUnwrittenFrames(pDelayLines[chan], pDelayLines[chan].oversampleFactor > 1
+                ? (int)in_uFrames * pDelayLines[chan].oversampleFactor : (int)in_uFrames / m_decimationFactor);
+        }
+        
+        if (pDelayLines[chan].oversampleFactor > 1)
+        {
+            pDelayLines[chan].writePos = (pDelayLines[chan].writePos + 
+                in_uFrames * pDelayLines[chan].oversampleFactor) & 
+                (pDelayLines[chan].effectiveBufferSize - 1);
+        }
+        else if (m_delayMemoryMode == DELAY_MEMORY_PAGED)
+        {
+            // Skipped audio was never written, so do not hold pages for it
+            ReleaseDelayPages(pDelayLines[chan]);
+            pDelayLines[chan].writePos = (pDelayLines[chan].writePos + in_uFrames / m_decimationFactor) & PAGED_BIT_MASK;
+        }
+        else
+        {
+            pDelayLines[chan].writePos = (pDelayLines[chan].writePos + in_uFrames / m_decimationFactor) &
+                (pDelayLines[chan].effectiveBufferSize - 1);
         }
     }
-    return AK_DataReady;
 }
@@ -28,16 +28,36 @@ the specific language governing permissions and limitations under the License.
 #define FlexibleDelayLinesFX_H
 
 #include "FlexibleDelayLinesFXParams.h"
+#include "FlexibleDelayLinesFXStorage.h"
+#include "FlexibleDelayLinesFXFilterDesign.h"
+
+#ifdef FLEXIBLEDELAYLINES_PROFILE_EXECUTE
+#include "FlexibleDelayLinesFXProfiler.h"
+#endif
 
 #define MAX_BUFFER_LEN (131072) // 2^17 for ~2.73s at 48kHz
 #define BIT_MASK (MAX_BUFFER_LEN - 1)
 
+// Short rings serve delays under ~85ms at 48kHz (Max Delay Time): 16 KB of Float32 stays in L1
+#define SHORT_BUFFER_LEN (4096)
+#define SHORT_DELAY_SPAN (SHORT_BUFFER_LEN - 16) // Room for the interpolators behind the longest delay
+
+// Paged rings span a much longer delay but only commit the pages the delay needs
+#define PAGED_BUFFER_LEN (2097152) // 2^21 for ~43.7s at 48kHz
+#define PAGED_BIT_MASK (PAGED_BUFFER_LEN - 1)
+#define DELAY_PAGE_SHIFT (12)
+#define DELAY_PAGE_LEN (1 << DELAY_PAGE_SHIFT) // 4096 samples per page
+#define DELAY_PAGE_MASK (DELAY_PAGE_LEN - 1)
+#define DELAY_PAGE_COUNT (PAGED_BUFFER_LEN / DELAY_PAGE_LEN)
+#define PAGED_DELAY_SPAN (PAGED_BUFFER_LEN - 2 * DELAY_PAGE_LEN) // Keeps the write head clear of pages held for reading
+
 enum InterpolationType
 {
     INTERP_LINEAR = 0,
     INTERP_POWER_COMPLEMENTARY = 1,
     INTERP_POLYNOMIAL_4POINT = 2,
-    INTERP_HYBRID = 3
+    INTERP_HYBRID = 3,
+    INTERP_RESAMPLER = 4           // Base-rate ring only, band-limited to the Doppler factor
 };
 
 enum OversamplingFactor
@@ -49,16 +69,66 @@ enum OversamplingFactor
     OVERSAMPLE_16X = 16
 };
 
+enum DelayMemoryMode
+{
+    DELAY_MEMORY_CONTIGUOUS = 0,
+    DELAY_MEMORY_PAGED = 1,
+    DELAY_MEMORY_POOLED = 2
+};
+
+enum DecimationFactor
+{
+    DECIMATE_NONE = 1,
+    DECIMATE_2X = 2,
+    DECIMATE_4X = 4
+};
+
+enum FilterPhase
+{
+    FILTER_PHASE_LINEAR = 0,
+    FILTER_PHASE_MINIMUM = 1
+};
+
+enum DistanceSource
+{
+    DISTANCE_SOURCE_RTPC = 0,
+    DISTANCE_SOURCE_NEAREST_LISTENER = 1,
+    DISTANCE_SOURCE_LISTENER_INDEX = 2,
+    DISTANCE_SOURCE_OBJECT_POSITION = 3    // Per audio object, from its listener-relative position
+};
+
+enum FeedbackMatrix
+{
+    FEEDBACK_MATRIX_NONE = 0,          // Each channel feeds back into itself
+    FEEDBACK_MATRIX_HOUSEHOLDER = 1,
+    FEEDBACK_MATRIX_HADAMARD = 2       // Householder when the line count is not a power of two
+};
+
+enum DistanceEffects
+{
+    DISTANCE_EFFECTS_NONE = 0,
+    DISTANCE_EFFECT_AIR_ABSORPTION = 1,
+    DISTANCE_EFFECT_ATTENUATION = 2      // Flags: 3 applies both
+};
+
+enum VirtualSnapshot
+{
+    VIRTUAL_SNAPSHOT_OFF = 0,
+    VIRTUAL_SNAPSHOT_FULL = 1,
+    VIRTUAL_SNAPSHOT_HALF = 2
+};
+
 enum UpSamplingMethod
 {
     UPSAMPLE_LINEAR = 0,
     UPSAMPLE_SIMPLE_SINC = 1,
-    UPSAMPLE_POLYPHASE = 2
+    UPSAMPLE_POLYPHASE = 2,
+    UPSAMPLE_IIR_HALFBAND = 3
 };
 
 /// See https://www.audiokinetic.com/library/edge/?source=SDK&id=soundengine__plugins__effects.html
 /// for the documentation about effect plug-ins
-class FlexibleDelayLinesFX : public AK::IAkInPlaceEffectPlugin
+class FlexibleDelayLinesFX : public AK::IAkInPlaceObjectPlugin
 {
 public:
     FlexibleDelayLinesFX();
@@ -79,13 +149,15 @@ public:
     /// information about the plug-in to determine its behavior.
     AKRESULT GetPluginInfo(AkPluginInfo& out_rPluginInfo) override;
 
-    /// Effect plug-in DSP execution.
-    void Execute(AkAudioBuffer* io_pBuffer) override;
+    /// Object processor DSP execution.
+    /// Every audio object is processed in place with its own delay lines, created when the object first
+    /// shows up and freed once it is gone. On a bus without audio objects the mix arrives as a single object.
+    void Execute(const AkAudioObjects& io_objects) override;
 
     /// Skips execution of some frames, when the voice is virtual playing from elapsed time.
     /// This can be used to simulate processing that would have taken place (e.g. update internal state).
     /// Return AK_DataReady or AK_NoMoreData, depending if there would be audio output or not at that point.
-    AKRESULT TimeSkip(AkUInt32 in_uFrames) override;
+    AKRESULT TimeSkip(const AkAudioObjects& io_objects, AkUInt32 in_uFrames) override;
 
 private:
     // ==================== INTERPOLATION METHODS ====================
@@ -106,13 +178,14 @@ private:
     }
     
     // 4-point polynomial interpolation (Lagrange, best for tones)
-    inline float InterpolatePolynomial4Point(float* buffer, int baseIndex, float t) const
+    template<typename Ring>
+    inline float InterpolatePolynomial4Point(const Ring& ring, int baseIndex, float t) const
     {
         // Get 4 points: y[-1], y[0], y[1], y[2]
-        float ym1 = buffer[(baseIndex - 1) & BIT_MASK];
-        float y0  = buffer[baseIndex & BIT_MASK];
-        float y1  = buffer[(baseIndex + 1) & BIT_MASK];
-        float y2  = buffer[(baseIndex + 2) & BIT_MASK];
+        float ym1 = ring.Read(baseIndex - 1);
+        float y0  = ring.Read(baseIndex);
+        float y1  = ring.Read(baseIndex + 1);
+        float y2  = ring.Read(baseIndex + 2);
         
         // 4-point Lagrange interpolation
         float c0 = y0;
@@ -136,66 +209,702 @@ private:
         return InterpolateLinear(buffer[idxA], buffer[idxB], subsampleT);
     }
     
+    // Variable-ratio resampler: a windowed sinc over RESAMPLER_TAPS samples around the read point,
+    // pKernels being the band picked for the current Doppler factor (see GetResamplerKernels).
+    // newestIndex is the newest sample under the kernel, RESAMPLER_TAPS / 2 - 1 samples after the read point.
+    template<typename Ring>
+    inline float InterpolateResampler(const Ring& ring, int newestIndex, float t, const float* pKernels) const
+    {
+        float position = t * (float)RESAMPLER_PHASES;
+        int phase = (int)position;
+        float phaseT = position - (float)phase;
+        
+        const float* pKernelA = pKernels + phase * RESAMPLER_TAPS;
+        const float* pKernelB = pKernelA + RESAMPLER_TAPS;
+        
+        float sum = 0.0f;
+        for (int tap = 0; tap < RESAMPLER_TAPS; ++tap)
+        {
+            float weight = pKernelA[tap] + phaseT * (pKernelB[tap] - pKernelA[tap]);
+            sum += weight * ring.Read(newestIndex - tap);
+        }
+        return sum;
+    }
+    
     // ==================== OVERSAMPLING ====================
     
+    struct DelayLineChannel;
+    
     // Sinc-based upsampling with windowed sinc function
     void UpsampleBuffer(float* input, float* output, int inputLength, int factor);
     
     // Polyphase FIR filter for efficient upsampling
-    void LinearUpsample(float* input, float* output, int inputLength, int factor);
-    void SimpleSincUpsample(float* input, float* output, int inputLength, int factor);
-    void PolyphaseUpsample(float* input, float* output, int inputLength, int factor);    
+    // (the channel is only used by the stateful methods)
+    void LinearUpsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor);
+    void SimpleSincUpsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor);
+    void PolyphaseUpsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor);    
+    
+    // Cascaded 2x polyphase IIR allpass half-bands, one stage per doubling, state kept across buffers
+    void HalfbandUpsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor);
+    
+    // Back down to the base rate; inputLength counts base-rate frames and output may alias input
+    void DropSampleDownsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor);
+    void HalfbandDownsample(DelayLineChannel& delayLine, float* input, float* output, int inputLength, int factor);
     
     // ==================== DELAY LINE CHANNEL ====================
     
     // Per-Channel delay line State
+    // Ring buffers hold samples in the instance's storage format (see FlexibleDelayLinesFXStorage.h)
     struct DelayLineChannel
     {
-        float* buffer;
-        float* oversampledBuffer;
+        AkUInt8* buffer;
+        AkUInt8* oversampledBuffer;
+        AkUInt8** pages;              // Paged mode only: DELAY_PAGE_COUNT entries, silent page when not committed
         float* tempUpsampledInput;
         float* tempDelayedOutput;
+        float* decimationHistory;     // Decimated mode only: input at the full rate, stored twice to avoid wrapping
+        float* interpolationHistory;  // Decimated mode only: delay output at the reduced rate, stored twice
+        float* halfbandState;         // IIR half-band oversampling only: allpass memory of both chains
+        float* upsampleHistory;       // Polyphase oversampling only: base-rate input, stored twice
+        int upsamplePos;
+        int decimationPos;
+        int interpolationPos;
+        int decimationPhase;          // Full-rate frames since the last decimated sample
         int writePos;
+        int firstWritePos;            // Pooled mode: where writing started since the rings came from the pool, -1 once the loop ring is all written
+        int restorePos;               // Oldest sample still to come back from the snapshot, see RestoreSnapshot
+        int numRestoreFrames;         // Samples from restorePos on still in the snapshot, 0 when none; they read as silence
+        AkInt64 delayPhase;
         float lastDelayTime;
         int oversampleFactor;
         int effectiveBufferSize;
+        int tailPage;                 // Oldest committed page
+        int numCommittedPages;        // Pages from tailPage up to the write head; a snapshot restore leaves silent ones in between
+        float dampingLowpassState;    // Feedback filter memory, see ApplyFeedbackFilter
+        float dampingHighpassState;
+        float dcBlockerInput;
+        float dcBlockerOutput;
+        float crossoverState[4];      // Band split only: both crossover biquads, see ProcessLowBand
+        float lowBandFilterState[4];  // Band split only: feedback filter memory of the 1x loop
+        float airAbsorptionState;     // Distance filter memory, see ApplyDistanceFilter
+        float distanceGain;           // Attenuation reached at the end of the last buffer
+        AkInt64 fadePhase;            // Delay of the head fading out after a jump
+        int crossfadeFrames;          // Frames left in the jump crossfade, 0 when not fading
+        int crossfadeLength;
         
         DelayLineChannel()
             : buffer(nullptr)
             , oversampledBuffer(nullptr)
+            , pages(nullptr)
             , tempUpsampledInput(nullptr)
             , tempDelayedOutput(nullptr)
+            , decimationHistory(nullptr)
+            , interpolationHistory(nullptr)
+            , halfbandState(nullptr)
+            , upsampleHistory(nullptr)
+            , upsamplePos(0)
+            , decimationPos(0)
+            , interpolationPos(0)
+            , decimationPhase(0)
             , writePos(0)
+            , firstWritePos(-1)
+            , restorePos(0)
+            , numRestoreFrames(0)
+            , delayPhase(0)
             , lastDelayTime(0.0f)
             , oversampleFactor(OVERSAMPLE_NONE)
             , effectiveBufferSize(MAX_BUFFER_LEN)
+            , tailPage(0)
+            , numCommittedPages(0)
+            , dampingLowpassState(0.0f)
+            , dampingHighpassState(0.0f)
+            , dcBlockerInput(0.0f)
+            , dcBlockerOutput(0.0f)
+            , crossoverState()
+            , lowBandFilterState()
+            , airAbsorptionState(0.0f)
+            , distanceGain(1.0f)
+            , fadePhase(0)
+            , crossfadeFrames(0)
+            , crossfadeLength(0)
         {}        
     };    
     
+    // ==================== DELAY LINE OBJECT ====================
+    
+    // Delay lines of one audio object, plus the pooled/paged memory state that goes with them
+    struct DelayLineObject
+    {
+        AkAudioObjectID key;          // AK_INVALID_AUDIO_OBJECT_ID until an object claims it
+        DelayLineChannel* pDelayLines;
+        AkUInt32 uNumChannels;
+        bool bDelayMemoryActive;
+        AkUInt32 uQuietFrames;        // Frames since the last non-silent input
+        bool bInUse;                  // Part of the current Execute
+        AkUInt8* pSnapshot;           // Allocated with the object when snapshots are on, see SaveSnapshot
+        AkUInt32 uSnapshotFrames;     // Samples per channel pSnapshot has room for
+        bool bSnapshotHeld;           // pSnapshot holds a tail that is not all back in the rings
+        AkUInt32 uReservedBlocks;     // Pool pages or base rings counted for this object, see ReserveDelayMemory
+        AkUInt32 uReservedOversampledBlocks;
+    };
+    
+    static constexpr AkUInt32 INITIAL_OBJECT_CAPACITY = 4;
+    
+    // ==================== RING VIEWS ====================
+    
+    // Sequential write into a contiguous ring of mask + 1 samples, split where it wraps
+    template<typename Storage>
+    static inline void StoreRingBlock(AkUInt8* buffer, int mask, int index, const float* values, int count)
+    {
+        const int first = count < mask + 1 - index ? count : mask + 1 - index;
+        Storage::StoreBlock(buffer, index, values, first);
+        if (first < count)
+            Storage::StoreBlock(buffer, 0, values + first, count - first);
+    }
+    
+    // Contiguous ring committed at Init; the short ring only differs by its length.
+    // A pooled ring comes back from the pool holding whatever its last user left: until the
+    // write head has gone all the way round, only what was written since firstWritePos is audio,
+    // less the stretch a snapshot restore has not reached yet.
+    template<typename Storage, int LENGTH = MAX_BUFFER_LEN, bool POOLED = false>
+    struct ContiguousRing
+    {
+        static constexpr bool IS_PAGED = false;
+        static constexpr bool IS_POOLED = POOLED;
+        static constexpr int MASK = LENGTH - 1;
+        static constexpr int DELAY_SPAN = LENGTH;
+        static constexpr bool BATCHED_STORE = Storage::BATCHED_STORE;
+        
+        AkUInt8* buffer;
+        int firstWritePos;
+        int restorePos;
+        int numRestoreFrames;
+        
+        explicit ContiguousRing(const DelayLineChannel& delayLine)
+            : buffer(delayLine.buffer)
+            , firstWritePos(POOLED ? delayLine.firstWritePos : -1)
+            , restorePos(POOLED ? delayLine.restorePos : 0)
+            , numRestoreFrames(POOLED ? delayLine.numRestoreFrames : 0) {}
+        
+        inline float Read(int index) const { return Storage::Load(buffer, index & MASK); }
+        inline void Write(int index, float value) { Storage::Store(buffer, index, value); }
+        inline void WriteBlock(int index, const float* values, int count) { StoreRingBlock<Storage>(buffer, MASK, index, values, count); }
+    };
+    
+    template<typename Storage>
+    using PooledRing = ContiguousRing<Storage, MAX_BUFFER_LEN, true>;
+    
+    // Read view of a pooled ring still filling up: what the head has not written yet, and what a
+    // snapshot restore has not put back yet, reads as silence
+    template<typename Ring>
+    struct FillingRing
+    {
+        static constexpr bool IS_PAGED = false;
+        static constexpr bool IS_POOLED = false;
+        static constexpr int MASK = Ring::MASK;
+        static constexpr int DELAY_SPAN = Ring::DELAY_SPAN;
+        
+        const Ring& ring;
+        const int firstPos;
+        const int numWritten;
+        const int restorePos;
+        const int numRestoreFrames;
+        
+        FillingRing(const Ring& in_ring, int writePos)
+            : ring(in_ring)
+            , firstPos(in_ring.firstWritePos)
+            , numWritten(in_ring.firstWritePos >= 0 ? (writePos - in_ring.firstWritePos) & MASK : MASK + 1)
+            , restorePos(in_ring.restorePos)
+            , numRestoreFrames(in_ring.numRestoreFrames) {}
+        
+        inline float Read(int index) const
+        {
+            return ((index - firstPos) & MASK) < numWritten && ((index - restorePos) & MASK) >= numRestoreFrames
+                ? ring.Read(index) : 0.0f;
+        }
+    };
+    
+    // Paged ring: uncommitted pages point to a shared silent page, so reads never branch
+    template<typename Storage>
+    struct PagedRing
+    {
+        static constexpr bool IS_PAGED = true;
+        static constexpr bool IS_POOLED = false;
+        static constexpr int MASK = PAGED_BIT_MASK;
+        static constexpr int DELAY_SPAN = PAGED_DELAY_SPAN;
+        static constexpr bool BATCHED_STORE = Storage::BATCHED_STORE;
+        static constexpr int firstWritePos = -1;      // Pooled rings only, see ContiguousRing
+        static constexpr int restorePos = 0;
+        static constexpr int numRestoreFrames = 0;    // Uncommitted pages already read as silence
+        
+        AkUInt8** pages;
+        
+        explicit PagedRing(const DelayLineChannel& delayLine) : pages(delayLine.pages) {}
+        
+        inline float Read(int index) const
+        {
+            index &= MASK;
+            return Storage::Load(pages[index >> DELAY_PAGE_SHIFT], index & DELAY_PAGE_MASK);
+        }
+        
+        inline void Write(int index, float value)
+        {
+            Storage::Store(pages[index >> DELAY_PAGE_SHIFT], index & DELAY_PAGE_MASK, value);
+        }
+        
+        // Split at page boundaries
+        inline void WriteBlock(int index, const float* values, int count)
+        {
+            while (count > 0)
+            {
+                const int offset = index & DELAY_PAGE_MASK;
+                const int run = count < DELAY_PAGE_LEN - offset ? count : DELAY_PAGE_LEN - offset;
+                Storage::StoreBlock(pages[index >> DELAY_PAGE_SHIFT], offset, values, run);
+                index = (index + run) & MASK;
+                values += run;
+                count -= run;
+            }
+        }
+    };
+    
+    // One-pole damping and DC blocker applied to the signal fed back into the ring,
+    // so every repeat is filtered once more. Coefficients are for the rate the loop runs at.
+    struct FeedbackFilter
+    {
+        float lowpass;                // One-pole coefficient, 1 lets everything through
+        float highpass;               // One-pole coefficient of the subtracted lowpass, 0 when off
+        float dcBlocker;              // Pole radius
+        bool bDCBlocker;
+        bool bEnabled;                // False when the filter would not change anything
+    };
+    
+    // Parameters shared by every channel for the current buffer
+    struct DelayLineBlockParams
+    {
+        float delayTime;              // Reached at the end of the buffer
+        float maxDelayTime;           // Longest delay anywhere in the buffer
+        const float* pDelayCurve;     // Delay at the end of each curveSegmentFrames segment, or nullptr for one ramp per buffer
+        int curveSegmentFrames;
+        float wetDryMix;
+        float feedback;
+        float delaySpread;            // FDN only
+        FeedbackFilter feedbackFilter;   // For m_fLoopSampleRate
+        FeedbackFilter lowBandFeedbackFilter;   // For m_fSampleRate, band split only
+        float distance;               // In meters, 0 when the delay does not come from a distance
+        float referenceDistance;
+        AkUInt32 distanceEffects;
+        float jumpThreshold;          // Delay change rate that triggers a crossfade, 0 when off
+        float crossfadeTime;          // In seconds
+        InterpolationType interpType;
+        int oversampleFactor;
+    };
+    
+    // ==================== FEEDBACK FILTER ====================
+    
+    FeedbackFilter ComputeFeedbackFilter(float dampingLowpass, float dampingHighpass, bool bDCBlocker, float loopSampleRate) const;
+    
+    inline float ApplyFeedbackFilter(DelayLineChannel& delayLine, const FeedbackFilter& filter, float x) const
+    {
+        return ApplyFeedbackFilter(filter, x, delayLine.dampingLowpassState, delayLine.dampingHighpassState,
+            delayLine.dcBlockerInput, delayLine.dcBlockerOutput);
+    }
+    
+    inline float ApplyFeedbackFilter(const FeedbackFilter& filter, float x, float& lowpassState, float& highpassState,
+        float& dcBlockerInput, float& dcBlockerOutput) const
+    {
+        lowpassState += filter.lowpass * (x - lowpassState);
+        float y = lowpassState;
+        
+        highpassState += filter.highpass * (y - highpassState);
+        y -= highpassState;
+        
+        float blocked = y - dcBlockerInput + filter.dcBlocker * dcBlockerOutput;
+        dcBlockerInput = y;
+        dcBlockerOutput = blocked;
+        
+        return filter.bDCBlocker ? blocked : y;
+    }
+    
+    // ==================== DISTANCE FILTER ====================
+    
+    // Air absorption (one-pole lowpass) and inverse-distance attenuation on the delayed signal
+    // before it is mixed in. The feedback keeps the unfiltered signal.
+    struct DistanceFilter
+    {
+        float absorption;             // One-pole coefficient, 1 lets everything through
+        float gain;                   // Ramps to targetGain over the buffer
+        float gainStep;
+        float targetGain;
+        bool bEnabled;
+    };
+    
+    DistanceFilter ComputeDistanceFilter(const DelayLineChannel& delayLine, const DelayLineBlockParams& blockParams,
+        float sampleRate, int numFrames) const;
+    
+    inline float ApplyDistanceFilter(DelayLineChannel& delayLine, DistanceFilter& filter, float x) const
+    {
+        delayLine.airAbsorptionState += filter.absorption * (x - delayLine.airAbsorptionState);
+        float y = delayLine.airAbsorptionState * filter.gain;
+        filter.gain += filter.gainStep;
+        return y;
+    }
+    
+    // Interpolated read from a base-rate ring, delayPhase samples behind writePos.
+    // pResamplerKernels is only read by INTERP_RESAMPLER. ReadStandardTap picks the view
+    // of the ring (see FillingRing), InterpolateStandardTap reads it.
+    template<typename Ring>
+    inline float ReadStandardTap(const Ring& ring, int writePos, AkInt64 delayPhase, InterpolationType interpType,
+        const float* pResamplerKernels) const;
+    template<typename Ring>
+    inline float InterpolateStandardTap(const Ring& ring, int writePos, AkInt64 delayPhase, InterpolationType interpType,
+        const float* pResamplerKernels) const;
+    
+    // Interpolated read from the oversampled ring, delayPhase samples behind the write head
+    template<typename Storage>
+    inline float ReadOversampledTap(const DelayLineChannel& delayLine, AkInt64 delayPhase, InterpolationType interpType) const;
+    
+    // Per-channel kernels, selected once at Init for the storage format and memory mode.
+    // WET_ONLY kernels write the delayed signal over the input, with no dry path.
+    template<typename Storage, bool WET_ONLY>
+    void ProcessOversampled(DelayLineChannel& delayLine, float* pChannel, AkUInt16 uValidFrames, const DelayLineBlockParams& blockParams);
+    
+    // Band split: hands the band above the crossover to the oversampler in pHighBand, and delays
+    // the band below in the base-rate ring, on the oversampled head's delay, into pLowBand
+    template<typename Storage>
+    void ProcessLowBand(DelayLineChannel& delayLine, const float* pInput, float* pLowBand, float* pHighBand,
+        AkUInt16 uValidFrames, const DelayLineBlockParams& blockParams);
+    template<typename Ring, bool WET_ONLY>
+    void ProcessStandard(DelayLineChannel& delayLine, float* pChannel, AkUInt16 uValidFrames, const DelayLineBlockParams& blockParams);
+    
+    // Short ring at a steady delay, Linear or 4-point: no ramp, curve or crossfade to follow, so the
+    // frames go through SHORT_STEADY_BLOCK at a time, all reads ahead of the block's writes.
+    // Same output as ProcessStandard, sample for sample.
+    template<typename Ring, bool WET_ONLY, bool POLYNOMIAL>
+    void ProcessShortSteady(DelayLineChannel& delayLine, float* pChannel, AkUInt16 uValidFrames,
+        const DelayLineBlockParams& blockParams, DistanceFilter& distanceFilter);
+    template<typename Ring, bool WET_ONLY, bool POLYNOMIAL>
+    inline void ProcessShortSteadyFrames(DelayLineChannel& delayLine, Ring& ring, float* pChannel, int count,
+        const DelayLineBlockParams& blockParams, DistanceFilter& distanceFilter);
+    
+    // Decimated mode: filters the input down, runs the standard kernel at the reduced rate and interpolates back up.
+    // The two filters delay the wet signal by m_decimationFIRLength - 1 frames on top of the delay time.
+    template<bool WET_ONLY>
+    void ProcessDecimated(DelayLineChannel& delayLine, float* pChannel, AkUInt16 uValidFrames, const DelayLineBlockParams& blockParams);
+    
+    typedef void (FlexibleDelayLinesFX::*ProcessFuncPtr)(DelayLineChannel&, float*, AkUInt16, const DelayLineBlockParams&);
+    
+    // ==================== FEEDBACK DELAY NETWORK ====================
+    
+    // Every channel of the object is one line; the delayed lines go through the feedback matrix
+    // before being written back. Full rate, no oversampling.
+    template<typename Ring, bool WET_ONLY>
+    void ProcessFDN(DelayLineObject& object, AkAudioBuffer* io_pBuffer, const DelayLineBlockParams& blockParams);
+    
+    typedef void (FlexibleDelayLinesFX::*ObjectProcessFuncPtr)(DelayLineObject&, AkAudioBuffer*, const DelayLineBlockParams&);
+    
+    static constexpr int FDN_MAX_LINES = 16;   // Objects with more channels keep per-channel feedback
+    
+    // ==================== MIX MODES ====================
+    
+    // The kernels of one mix mode for the storage format and memory mode picked at Init
+    struct MixKernels
+    {
+        ProcessFuncPtr oversampled;
+        ProcessFuncPtr standard;
+        ProcessFuncPtr decimated;
+        ObjectProcessFuncPtr fdn;
+    };
+    
+    static constexpr int MIX_WET_DRY = 0;
+    static constexpr int MIX_WET_ONLY = 1;   // Wet/Dry Mix at 100%, as on most aux sends
+    
+    template<typename Storage, typename Ring>
+    void InitializeMixKernels();
+    
+    MixKernels m_mixKernels[2];            // Indexed by MIX_WET_DRY or MIX_WET_ONLY
+    const MixKernels* m_pMixKernels;       // Switched by UpdateParamBlockParams when Wet/Dry Mix changes
+    
+    // Paged mode: commits the pages written this buffer and releases the ones the delay no longer reaches.
+    // Returns false when the pool could not provide a page.
+    bool UpdateDelayPages(DelayLineChannel& delayLine, AkInt64 targetPhase, AkUInt16 uValidFrames);
+    void ReleaseDelayPages(DelayLineChannel& delayLine);
+    
+    // Pooled and paged modes only hold delay memory while there is something to play.
+    // Activation returns false when the pool has no room; the caller then passes the dry signal through.
+    // Only object setup allocates pool blocks: it reserves the ones the object would need,
+    // and freeing the object takes the reservation back.
+    void ReserveDelayMemory(DelayLineObject& object);
+    void UnreserveDelayMemory(DelayLineObject& object);
+    float GetMaxDelaySamples() const;
+    bool ActivateDelayMemory(DelayLineObject& object);
+    void DeactivateDelayMemory(DelayLineObject& object);
+    bool HasSignal(AkAudioBuffer* io_pBuffer) const;
+    float GetTailFrames(float delayTime, float feedback) const;
+    
+    // Pooled mode: rings are not cleared when they come from the pool, see FillingRing. Clears up to
+    // numFrames loop-rate samples ahead of the head that were never written; reaching firstWritePos
+    // marks the rings full, so the reads stop checking.
+    void ClearUnwrittenFrames(DelayLineChannel& delayLine, int numFrames);
+    void ClearRingFrames(AkUInt8* pRing, int mask, int firstPos, int numFrames) const;
+    
+    // Paged mode: commits the pages under numFrames samples from firstPos, extending the committed run
+    // or filling the silent pages a snapshot restore left in it
+    bool CommitDelayPages(DelayLineChannel& delayLine, int firstPos, int numFrames);
+    
+    // ==================== VIRTUAL VOICE SNAPSHOT ====================
+    
+    // On the first TimeSkip the samples the read heads can still reach are copied aside and the
+    // rings go back to the pool; once the voice returns they go back a few buffers at a time, oldest
+    // first and ahead of the read head, so the tail resumes where it stopped.
+    // Base-rate rings only (no oversampling or decimation).
+    struct DelayLineChannelSnapshot
+    {
+        AkInt64 delayPhase;
+        float lastDelayTime;
+        float dampingLowpassState;
+        float dampingHighpassState;
+        float dcBlockerInput;
+        float dcBlockerOutput;
+        float airAbsorptionState;
+        float distanceGain;
+        int liveFrames;               // Samples that follow the header, oldest first
+    };
+    
+    // The snapshot storage is allocated with the object, for the longest delay it can reach.
+    // SaveSnapshot returns false when the tail does not fit, or for a loop that does not run on the
+    // base-rate ring; the rings are then kept as they are.
+    // BeginSnapshotRestore expects active delay memory. RestoreSnapshot then runs before every
+    // buffer of numFrames until the tail is all back; a tail the page pool cannot hold, or one the
+    // delay shortens past before it is back, comes back silent.
+    bool SaveSnapshot(DelayLineObject& object);
+    void BeginSnapshotRestore(DelayLineObject& object);
+    void RestoreSnapshot(DelayLineObject& object, int numFrames);
+    void DiscardSnapshot(DelayLineObject& object);
+    void AllocateSnapshot(DelayLineObject& object);
+    void FreeSnapshot(DelayLineObject& object);
+    int GetSnapshotFrames(const DelayLineChannel& delayLine) const;
+    AkUInt8* GetSnapshotSamples(const DelayLineObject& object, AkUInt32 chan) const;
+    
+    // Live region of one channel to snapshot samples, and numFrames of them from firstPos back,
+    // in the snapshot format
+    template<typename Ring>
+    void EncodeSnapshot(DelayLineChannel& delayLine, AkUInt8* pSamples, int liveFrames);
+    template<typename Ring>
+    void DecodeSnapshot(DelayLineChannel& delayLine, const AkUInt8* pSamples, int firstPos, int numFrames);
+    
+    typedef void (FlexibleDelayLinesFX::*EncodeSnapshotFuncPtr)(DelayLineChannel&, AkUInt8*, int);
+    typedef void (FlexibleDelayLinesFX::*DecodeSnapshotFuncPtr)(DelayLineChannel&, const AkUInt8*, int, int);
+    EncodeSnapshotFuncPtr m_encodeSnapshotFunction;
+    DecodeSnapshotFuncPtr m_decodeSnapshotFunction;
+    
+    // ==================== AUDIO OBJECTS ====================
+    
+    // Allocates the delay lines of an object for the instance's memory mode; FreeDelayLines
+    // cleans up after a partial allocation
+    AKRESULT AllocateDelayLines(DelayLineObject& object, AkUInt32 uNumChannels);
+    void FreeDelayLines(DelayLineObject& object);
+    void ResetDelayLines(DelayLineObject& object);
+    
+    DelayLineObject* FindObject(AkAudioObjectID key);
+    // Finds the object's delay lines, adopting an unclaimed set of the same width before allocating.
+    // Returns nullptr when out of memory; the object then goes through dry.
+    DelayLineObject* AcquireObject(AkAudioObjectID key, AkUInt32 uNumChannels);
+    void RemoveUnusedObjects();
+    
+    void ProcessObject(DelayLineObject& object, AkAudioBuffer* io_pBuffer, const DelayLineBlockParams& blockParams);
+    
+    // Tells the Capture Log, once, that a delay went past the short ring and is being clamped
+    void ReportShortRingClamp(float maxDelayTime);
+    
+    // Tells the Capture Log, once, that the pool could not hold the blocks an object reserved
+    void ReportPoolShortfall();
+    void SkipObject(DelayLineObject& object, AkUInt32 in_uFrames);
+    
+    // ==================== PARAMETERS ====================
+    
+    // Takes the latest published parameters into m_params and refreshes the block parameters that
+    // depend on the ones that changed. Returns false when the previous buffer's copy stays.
+    bool AcquireParams();
+    // Recomputes the fields of m_paramBlockParams flagged in m_params.changes, then clears the flags
+    void UpdateParamBlockParams();
+    
+    // ==================== DISTANCE ====================
+    
+    float DistanceToDelayTime(float distance) const;
+    // Emitter-listener distance from the sound engine for the selected Distance Source.
+    // Returns false for the other sources or when the voice has no listener, leaving the Distance RTPC in charge.
+    bool GetEngineDistance(float& out_distance) const;
+    
+    // ==================== DELAY CURVE ====================
+    
+    // Picks up a newly submitted curve, starting from the delay currently applied
+    void LoadDelayCurve(float currentDelayTime);
+    float EvaluateDelayCurve(double time);
+    // Fills blockParams with the curve's trajectory over the buffer; returns false when no curve applies
+    bool UpdateDelayCurve(AkUInt16 uValidFrames, DelayLineBlockParams& blockParams);
+    
     FlexibleDelayLinesFXParams* m_pParams;
+    FlexibleDelayLinesParamsSnapshot m_params;    // Read by Execute instead of m_pParams, see AcquireParams
+    AkUInt32 m_uParamsSequence;
+    DelayLineBlockParams m_paramBlockParams;      // Fields derived from m_params alone
     AK::IAkPluginMemAlloc* m_pAllocator;
     AK::IAkEffectPluginContext* m_pContext;
     
-    DelayLineChannel* m_pDelayLines;
-    AkUInt32 m_uNumChannels;
+    DelayLineObject* m_pObjects;
+    AkUInt32 m_uNumObjects;
+    AkUInt32 m_uMaxObjects;
     float m_fSampleRate;
     float m_fSamplesPerMeter;
+    float m_fLoopSampleRate;          // Rate of the feedback loop, after oversampling or decimation
+    
+    AkUInt32 m_storageFormat;
+    int m_storageBytesPerSample;
+    AkUInt32 m_delayMemoryMode;
+    AkUInt32 m_virtualSnapshot;       // VIRTUAL_SNAPSHOT_OFF when the memory mode or rate cannot use it
+    int m_oversampleFactor;        // Effective factor after the memory mode and decimation
+    bool m_bShortRing;             // Base-rate rings of SHORT_BUFFER_LEN samples
+    bool m_bShortRingClampReported;   // Once per instance, see ReportShortRingClamp
+    bool m_bPoolShortfallReported;    // Once per instance, see ReportPoolShortfall
+    AkUInt32 m_ringBytes;          // Of each contiguous base-rate ring
+    AkUInt32 m_feedbackMatrix;
+    float m_fdnLineSpread[FDN_MAX_LINES];      // Line delay = delay * (1 + spread * m_fdnLineSpread[line])
     
     static constexpr int m_powerCompTableSize = 256;
     float m_powerCompTable[m_powerCompTableSize];
+    float m_crossfadeInTable[m_powerCompTableSize];   // Jump crossfade gains: square roots of m_powerCompTable
+    float m_crossfadeOutTable[m_powerCompTableSize];  // and of its complement, for equal power
     
     float* m_pFIRCoefficients;
     int m_FIRLength;
     
-    typedef void (FlexibleDelayLinesFX::*UpsampleFuncPtr)(float*, float*, int, int);
+    static constexpr int UPSAMPLE_HISTORY_LEN = 16;       // Power of two above the taps per polyphase branch
+    
+    // Group delay of the oversampling filters, up and down, at the oversampled rate.
+    // The output tap is read this much earlier so the wet signal lands on the requested delay.
+    AkInt64 m_oversamplingLatencyPhase;
+    
+    // Band split: Linkwitz-Riley lowpass at the crossover, two identical Butterworth biquads.
+    // The high band is the input minus the low band; the two sum back to the input when the
+    // oversampling filters are linear phase, see ResolveEffectiveSettings.
+    bool m_bBandSplit;
+    float m_crossoverCoefs[5];        // b0, b1, b2, a1, a2
+    
+    static constexpr int DECIMATION_HISTORY_LEN = 128;    // Power of two above the longest decimation FIR
+    static constexpr int INTERPOLATION_HISTORY_LEN = 32;  // Power of two above the taps per interpolation phase
+    static constexpr int DECIMATION_CHUNK_LEN = 256;      // Reduced-rate samples handed to the kernel at once
+    
+    int m_decimationFactor;
+    float* m_pDecimationFIR;              // Lowpass at the full rate, used by both halves of the chain
+    int m_decimationFIRLength;
+    float* m_pInterpolationPolyphase;     // The same lowpass split into one branch per output phase, gain included
+    int m_interpolationTapsPerPhase;
+    float m_decimatedScratch[DECIMATION_CHUNK_LEN];
+    
+    typedef void (FlexibleDelayLinesFX::*UpsampleFuncPtr)(DelayLineChannel&, float*, float*, int, int);
     UpsampleFuncPtr m_upsampleFunction;
+    UpsampleFuncPtr m_downsampleFunction;
+    
+    // Half-band stages, indexed from the base rate up; the first one has the narrowest transition
+    static constexpr int HALFBAND_MAX_STAGES = HALFBAND_CASCADE_MAX_STAGES;
+    static constexpr int HALFBAND_MAX_COEFS = HALFBAND_CASCADE_MAX_COEFS;
+    static constexpr int HALFBAND_STAGE_STATE_LEN = HALFBAND_MAX_COEFS * 2;
+    static constexpr int HALFBAND_STATE_LEN = HALFBAND_STAGE_STATE_LEN * HALFBAND_MAX_STAGES * 2;
+    
+    int m_halfbandNumStages;
+    int m_halfbandNumCoefs[HALFBAND_MAX_STAGES];
+    float m_halfbandCoefs[HALFBAND_MAX_STAGES][HALFBAND_MAX_COEFS];
+    
+    // Variable-ratio resampler: one band of kernels per anti-aliasing cutoff, each lower cutoff
+    // serving a higher Doppler factor. Designed once and shared by all instances.
+    static constexpr int RESAMPLER_TAPS = 16;
+    static constexpr int RESAMPLER_PHASES = 64;           // Rows interpolated linearly in between
+    static constexpr int RESAMPLER_BANDS = 4;
+    static constexpr int RESAMPLER_BAND_LEN = (RESAMPLER_PHASES + 1) * RESAMPLER_TAPS;
+    
+    static float s_resamplerKernels[RESAMPLER_BANDS * RESAMPLER_BAND_LEN];
+    static bool s_bResamplerKernelsDesigned;
+    const float* m_pResamplerKernels;     // s_resamplerKernels once designed, nullptr unless INTERP_RESAMPLER
+    
+    // Samples past the delay that any interpolator reads, the resampler's half span
+    static constexpr int INTERPOLATOR_REACH = RESAMPLER_TAPS / 2;
+    
+    // The kernels hold back up to this many ring writes and store them with the codec's StoreBlock
+    static constexpr int STAGED_WRITE_LEN = 128;
+    static constexpr int SHORT_STEADY_BLOCK = 4;       // Frames per iteration of ProcessShortSteady
+    static constexpr int STAGED_WRITE_MIN_LEN = 4;       // Shorter runs are written one sample at a time
+    static constexpr int SNAPSHOT_RESTORE_RATE = 4;      // Snapshot samples put back per frame played, at least
+    
+    static constexpr int DELAY_CURVE_CONTROL_FRAMES = 8;  // Curve evaluated this often, linear in between
+    static constexpr int DELAY_CURVE_MAX_SEGMENTS = 512;
+    
+    float m_delayCurveTimes[DELAY_CURVE_MAX_POINTS + 1];  // Seconds since the curve was loaded
+    float m_delayCurveValues[DELAY_CURVE_MAX_POINTS + 1]; // Delay in seconds
+    int m_delayCurveNumPoints;                            // 0 when no curve applies
+    int m_delayCurveCursor;
+    double m_delayCurveTime;
+    AkUInt32 m_uDelayCurveVersion;
+    float m_delayCurveRTPCDelayTime;                      // RTPC values when the curve was loaded;
+    float m_delayCurveRTPCDistance;                       // moving either one hands control back
+    float m_delayCurveSegments[DELAY_CURVE_MAX_SEGMENTS];
+    
+#ifdef FLEXIBLEDELAYLINES_PROFILE_EXECUTE
+    // Execute latency, reported to the Wwise profiler on Term
+    FlexibleDelayLinesFXProfiler m_profiler;
+    void ReportProfile() const;
+#endif
     
     static constexpr float SPEED_OF_SOUND = 343.0f; // in m/s
     static constexpr float PI = 3.14159265358979323846f;
+    static constexpr float SILENCE_THRESHOLD = 1.0e-5f; // About -100 dBFS
+    static constexpr float DAMPING_LOWPASS_OFF = 20000.0f; // Top of the Damping Lowpass range, in Hz
+    static constexpr float DC_BLOCKER_CUTOFF = 10.0f;      // in Hz
+    static constexpr float AIR_ABSORPTION_DB = 1.0e-9f;    // dB per meter per Hz squared, about 0.1 dB/m at 10 kHz
+    static constexpr float MIN_REFERENCE_DISTANCE = 0.1f;  // in m
+    
+    // Delay phase in 32.32 fixed-point samples, at the rate of the ring it indexes
+    static constexpr int DELAY_PHASE_SHIFT = 32;
+    static constexpr AkInt64 DELAY_PHASE_ONE = (AkInt64)1 << DELAY_PHASE_SHIFT;
+    static constexpr AkInt64 DELAY_PHASE_FRAC_MASK = DELAY_PHASE_ONE - 1;
+    static constexpr float DELAY_PHASE_FRAC_SCALE = 1.0f / 4294967296.0f;
+    
+    // Converts a delay time to a fixed-point phase, clamped so that the
+    // interpolators never read past the oldest sample held by the ring
+    inline AkInt64 DelayTimeToPhase(float delayTime, int oversampleFactor, int bufferSize) const
+    {
+        double samplesDelayed = (double)delayTime * (double)m_fSampleRate * (double)oversampleFactor;
+        double maxSamplesDelayed = (double)(bufferSize - 4);
+        
+        if (samplesDelayed < 0.0)
+            samplesDelayed = 0.0;
+        else if (samplesDelayed > maxSamplesDelayed)
+            samplesDelayed = maxSamplesDelayed;
+        
+        return (AkInt64)(samplesDelayed * (double)DELAY_PHASE_ONE);
+    }
+    
+    // Shortest delay the buffer ramps through, from startPhase to the last target it aims at
+    AkInt64 GetMinDelayPhase(AkInt64 startPhase, const DelayLineBlockParams& blockParams, int numFrames, int oversampleFactor, int bufferSize) const;
+    
+    // How many writes may be held back while every read stays behind them, 0 to write each one
+    static inline int GetStagedWriteLength(AkInt64 minDelayPhase)
+    {
+        const AkInt64 length = (minDelayPhase >> DELAY_PHASE_SHIFT) - INTERPOLATOR_REACH;
+        if (length < STAGED_WRITE_MIN_LEN)
+            return 0;
+        return length < STAGED_WRITE_LEN ? (int)length : STAGED_WRITE_LEN;
+    }
+    
+    // Each copies the baked table when in_pTables has one, and designs it otherwise
+    void InitializePowerComplementaryTable(const FlexibleDelayLinesFilterTables* in_pTables);
+    void InitializeFIRCoefficients(int oversampleFactor, AkUInt32 filterPhase, const FlexibleDelayLinesFilterTables* in_pTables);
+    bool InitializeDecimationFilters(int decimationFactor, const FlexibleDelayLinesFilterTables* in_pTables);
+    bool InitializeHalfbandCoefficients(int oversampleFactor, const FlexibleDelayLinesFilterTables* in_pTables);
+    void InitializeResamplerKernels();
+    float GetHalfbandLatency(int oversampleFactor) const;
+    void InitializeCrossover(float crossoverFrequency);
     
-    void InitializePowerComplementaryTable();
-    void InitializeFIRCoefficients(int oversampleFactor);
-    float CalculateDopplerShift(float currentDelay, float previousDelay, float bufferDuration) const;
+    // Kernels of the resampler band for a head moving by phaseIncrement per sample
+    const float* GetResamplerKernels(AkInt64 phaseIncrement) const;
 };
 
 #endif // FlexibleDelayLinesFX_H
@@ -0,0 +1,212 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef FlexibleDelayLinesFXCostModel_H
+#define FlexibleDelayLinesFXCostModel_H
+
+#include "FlexibleDelayLinesFX.h"
+
+// Shared by the sound engine plug-in, which runs with these settings and allocates these sizes,
+// and the authoring plug-in, which estimates the cost of a ShareSet from them.
+// Header only: the authoring plug-in does not build the sound engine sources.
+
+/// Settings an instance actually runs with. Combinations the DSP does not support fall back
+/// the same way in Init and in the estimate.
+struct FlexibleDelayLinesEffectiveSettings
+{
+    AkUInt32 interpolationType;
+    AkUInt32 upsamplingMethod;
+    AkUInt32 storageFormat;
+    AkUInt32 delayMemoryMode;
+    AkUInt32 feedbackMatrix;
+    AkUInt32 distanceEffects;
+    AkUInt32 virtualSnapshot;
+    int decimationFactor;
+    int oversampleFactor;
+    bool bShortRing;             // Contiguous 1x ring of SHORT_BUFFER_LEN samples
+    AkUInt32 bandSplitCrossover; // In Hz, 0 when the oversampled path takes the full band
+};
+
+inline FlexibleDelayLinesEffectiveSettings ResolveEffectiveSettings(const FlexibleDelayLinesNonRTPCParams& in_params, float in_fSampleRate)
+{
+    FlexibleDelayLinesEffectiveSettings settings;
+    settings.interpolationType = in_params.interpolationType;
+    settings.upsamplingMethod = in_params.upsamplingMethod;
+    settings.distanceEffects = in_params.distanceEffects;
+
+    // The ring format is fixed for the lifetime of the instance
+    settings.storageFormat = in_params.storageFormat > STORAGE_PACKED24 ? (AkUInt32)STORAGE_FLOAT32 : in_params.storageFormat;
+    settings.delayMemoryMode = in_params.delayMemoryMode > DELAY_MEMORY_POOLED ? (AkUInt32)DELAY_MEMORY_CONTIGUOUS : in_params.delayMemoryMode;
+
+    // The FDN mixes its lines sample by sample at the base rate
+    settings.feedbackMatrix = in_params.feedbackMatrix > FEEDBACK_MATRIX_HADAMARD ? (AkUInt32)FEEDBACK_MATRIX_NONE : in_params.feedbackMatrix;
+
+    // A decimated loop has no use for oversampling either
+    settings.decimationFactor = (int)in_params.decimationFactor;
+    if ((settings.decimationFactor != DECIMATE_2X && settings.decimationFactor != DECIMATE_4X)
+        || settings.feedbackMatrix != FEEDBACK_MATRIX_NONE)
+        settings.decimationFactor = DECIMATE_NONE;
+
+    // Paged rings run at 1x only: oversampling a ring this long would defeat the purpose.
+    // The resampler reads the base-rate ring directly.
+    settings.oversampleFactor = (settings.delayMemoryMode == DELAY_MEMORY_PAGED
+        || settings.interpolationType == INTERP_RESAMPLER
+        || settings.decimationFactor > DECIMATE_NONE
+        || settings.feedbackMatrix != FEEDBACK_MATRIX_NONE)
+        ? OVERSAMPLE_NONE : (int)in_params.oversamplingFactor;
+
+    // Snapshots only hold base-rate rings, and contiguous rings stay allocated anyway
+    settings.virtualSnapshot = in_params.virtualSnapshot;
+    if (settings.virtualSnapshot > VIRTUAL_SNAPSHOT_HALF
+        || settings.delayMemoryMode == DELAY_MEMORY_CONTIGUOUS
+        || settings.oversampleFactor > OVERSAMPLE_NONE
+        || settings.decimationFactor > DECIMATE_NONE)
+        settings.virtualSnapshot = VIRTUAL_SNAPSHOT_OFF;
+
+    // A delay known to stay short gets a ring that fits in cache, at the base rate only
+    const float maxDelaySamples = (float)in_params.maxDelayTime * 0.001f * in_fSampleRate;
+    settings.bShortRing = in_params.maxDelayTime > 0
+        && maxDelaySamples <= (float)SHORT_DELAY_SPAN
+        && settings.delayMemoryMode == DELAY_MEMORY_CONTIGUOUS
+        && settings.oversampleFactor == OVERSAMPLE_NONE;
+
+    // The low band is delayed at 1x, which only stays alias-free well below Nyquist. It is
+    // aligned on the oversampling filters' latency, so the bands only sum back flat around
+    // linear-phase, unity-gain filters: the IIR half-bands shift the phase with frequency,
+    // and the simple sinc is not unity at DC.
+    settings.bandSplitCrossover = in_params.bandSplitCrossover;
+    if (settings.oversampleFactor == OVERSAMPLE_NONE
+        || settings.upsamplingMethod == UPSAMPLE_SIMPLE_SINC
+        || settings.upsamplingMethod == UPSAMPLE_IIR_HALFBAND
+        || (float)settings.bandSplitCrossover > 0.25f * in_fSampleRate)
+        settings.bandSplitCrossover = 0;
+
+    return settings;
+}
+
+/// Bytes of one channel's delay ring at the given rate multiple (contiguous or pooled).
+inline AkUInt32 GetDelayRingBytes(AkUInt32 in_storageFormat, int in_oversampleFactor)
+{
+    return (AkUInt32)GetDelayStorageBytesPerSample(in_storageFormat) * MAX_BUFFER_LEN * (AkUInt32)in_oversampleFactor;
+}
+
+/// Bytes of one channel's short ring, see FlexibleDelayLinesEffectiveSettings::bShortRing.
+inline AkUInt32 GetShortRingBytes(AkUInt32 in_storageFormat)
+{
+    return (AkUInt32)GetDelayStorageBytesPerSample(in_storageFormat) * SHORT_BUFFER_LEN;
+}
+
+/// Bytes of each of the two float scratch buffers an oversampled channel works in.
+inline AkUInt32 GetOversampledScratchBytes(int in_oversampleFactor)
+{
+    return (AkUInt32)sizeof(float) * MAX_BUFFER_LEN * (AkUInt32)in_oversampleFactor;
+}
+
+// ==================== COST ESTIMATE ====================
+// CPU is in units of one 1x Linear channel on a moving delay, contiguous Float32, no other
+// option (about 0.025% of one x86-64 core at 48 kHz). The factors were measured with 512-frame
+// buffers; they rank configurations, they do not predict a given platform.
+
+static constexpr float COST_INTERPOLATION[5] = { 1.0f, 1.3f, 2.1f, 1.5f, 5.5f }; // Indexed by InterpolationType, 1x only
+static constexpr float COST_UPSAMPLING[4] = { 1.9f, 45.0f, 3.5f, 4.5f };       // Indexed by UpSamplingMethod, per unit of factor
+static constexpr float COST_STORAGE[4] = { 1.0f, 1.9f, 2.2f, 3.2f };           // Indexed by DelayStorageFormat, per ring access
+static constexpr float COST_DECIMATE_2X = 6.8f;    // Both FIRs included
+static constexpr float COST_DECIMATE_4X = 5.0f;
+static constexpr float COST_PAGED_MEMORY = 0.3f;
+static constexpr float COST_DISTANCE_EFFECTS = 0.4f;
+static constexpr float COST_FEEDBACK_MATRIX[3] = { 0.0f, 0.2f, 1.6f };         // Indexed by FeedbackMatrix, per line
+static constexpr float COST_BAND_SPLIT = 2.5f;     // Crossover and the low band's 4-point 1x loop
+
+struct FlexibleDelayLinesCostEstimate
+{
+    AkUInt32 uBytesPerChannel;   // Delay memory of one channel while its voice is audible
+    float fCPUPerChannel;        // In 1x Linear channels, see above
+};
+
+/// Estimates one channel of an instance. in_fDelayTime only matters to paged rings,
+/// which commit the pages under the current delay.
+inline FlexibleDelayLinesCostEstimate EstimateCost(const FlexibleDelayLinesEffectiveSettings& in_settings, float in_fDelayTime, float in_fSampleRate)
+{
+    FlexibleDelayLinesCostEstimate estimate;
+    const int oversampleFactor = in_settings.oversampleFactor;
+    const AkUInt32 bytesPerSample = (AkUInt32)GetDelayStorageBytesPerSample(in_settings.storageFormat);
+
+    // ---- Memory ----
+    if (in_settings.delayMemoryMode == DELAY_MEMORY_PAGED)
+    {
+        float delaySamples = in_fDelayTime * in_fSampleRate;
+        if (delaySamples > (float)PAGED_DELAY_SPAN)
+            delaySamples = (float)PAGED_DELAY_SPAN;
+
+        // The pages under the delay, the one being written and the one being read from
+        const AkUInt32 numPages = (AkUInt32)(delaySamples > 0.0f ? delaySamples : 0.0f) / DELAY_PAGE_LEN + 2;
+        estimate.uBytesPerChannel = numPages * DELAY_PAGE_LEN * bytesPerSample + (AkUInt32)sizeof(AkUInt8*) * DELAY_PAGE_COUNT;
+    }
+    else if (in_settings.bShortRing)
+    {
+        estimate.uBytesPerChannel = GetShortRingBytes(in_settings.storageFormat);
+    }
+    else
+    {
+        estimate.uBytesPerChannel = GetDelayRingBytes(in_settings.storageFormat, OVERSAMPLE_NONE);
+        if (oversampleFactor > OVERSAMPLE_NONE)
+        {
+            estimate.uBytesPerChannel += GetDelayRingBytes(in_settings.storageFormat, oversampleFactor)
+                + GetOversampledScratchBytes(oversampleFactor) * 2;
+        }
+    }
+
+    // ---- CPU ----
+    const float storageCost = COST_STORAGE[in_settings.storageFormat <= STORAGE_PACKED24 ? in_settings.storageFormat : (AkUInt32)STORAGE_FLOAT32];
+    float cpu;
+    if (oversampleFactor > OVERSAMPLE_NONE)
+    {
+        const AkUInt32 upsampling = in_settings.upsamplingMethod <= UPSAMPLE_IIR_HALFBAND ? in_settings.upsamplingMethod : (AkUInt32)UPSAMPLE_LINEAR;
+        cpu = (COST_UPSAMPLING[upsampling] + storageCost - 1.0f) * (float)oversampleFactor;
+        if (in_settings.bandSplitCrossover > 0)
+            cpu += COST_BAND_SPLIT + storageCost - 1.0f;
+    }
+    else if (in_settings.decimationFactor > DECIMATE_NONE)
+    {
+        cpu = (in_settings.decimationFactor == DECIMATE_2X ? COST_DECIMATE_2X : COST_DECIMATE_4X) + storageCost - 1.0f;
+    }
+    else
+    {
+        const AkUInt32 interpolation = in_settings.interpolationType <= INTERP_RESAMPLER ? in_settings.interpolationType : (AkUInt32)INTERP_LINEAR;
+        cpu = COST_INTERPOLATION[interpolation] + storageCost - 1.0f;
+    }
+
+    if (in_settings.delayMemoryMode == DELAY_MEMORY_PAGED)
+        cpu += COST_PAGED_MEMORY;
+    if (in_settings.distanceEffects != DISTANCE_EFFECTS_NONE)
+        cpu += COST_DISTANCE_EFFECTS;
+    cpu += COST_FEEDBACK_MATRIX[in_settings.feedbackMatrix];
+
+    estimate.fCPUPerChannel = cpu;
+    return estimate;
+}
+
+#endif // FlexibleDelayLinesFXCostModel_H
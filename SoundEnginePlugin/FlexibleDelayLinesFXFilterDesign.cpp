@@ -0,0 +1,330 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "FlexibleDelayLinesFXFilterDesign.h"
+
+#include <math.h>
+
+static const double FILTER_DESIGN_PI = 3.14159265358979323846;
+static const float FILTER_DESIGN_PI_F = 3.14159265358979323846f;
+
+// Iterative radix-2 FFT, in place; in_size must be a power of two
+static void TransformInPlace(double* io_pReal, double* io_pImag, int in_size, bool in_bInverse)
+{
+    for (int i = 1, j = 0; i < in_size; ++i)
+    {
+        int bit = in_size >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        
+        if (i < j)
+        {
+            double tmpReal = io_pReal[i];
+            double tmpImag = io_pImag[i];
+            io_pReal[i] = io_pReal[j];
+            io_pImag[i] = io_pImag[j];
+            io_pReal[j] = tmpReal;
+            io_pImag[j] = tmpImag;
+        }
+    }
+    
+    for (int length = 2; length <= in_size; length <<= 1)
+    {
+        const double angle = (in_bInverse ? 2.0 : -2.0) * FILTER_DESIGN_PI / (double)length;
+        const double stepReal = cos(angle);
+        const double stepImag = sin(angle);
+        const int half = length / 2;
+        
+        for (int start = 0; start < in_size; start += length)
+        {
+            double twiddleReal = 1.0;
+            double twiddleImag = 0.0;
+            
+            for (int k = 0; k < half; ++k)
+            {
+                double* pA = io_pReal + start + k;
+                double* pAImag = io_pImag + start + k;
+                double bReal = pA[half] * twiddleReal - pAImag[half] * twiddleImag;
+                double bImag = pA[half] * twiddleImag + pAImag[half] * twiddleReal;
+                
+                pA[half] = *pA - bReal;
+                pAImag[half] = *pAImag - bImag;
+                *pA += bReal;
+                *pAImag += bImag;
+                
+                double nextReal = twiddleReal * stepReal - twiddleImag * stepImag;
+                twiddleImag = twiddleReal * stepImag + twiddleImag * stepReal;
+                twiddleReal = nextReal;
+            }
+        }
+    }
+    
+    if (in_bInverse)
+    {
+        const double scale = 1.0 / (double)in_size;
+        for (int i = 0; i < in_size; ++i)
+        {
+            io_pReal[i] *= scale;
+            io_pImag[i] *= scale;
+        }
+    }
+}
+
+bool DesignMinimumPhaseFIR(const float* in_pLinearPhase, float* out_pMinimumPhase, int in_length, AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    // A long transform keeps the cepstrum from aliasing onto itself
+    int size = 1024;
+    while (size < in_length * 16)
+        size <<= 1;
+    
+    double* pReal = (double*)AK_PLUGIN_ALLOC(in_pAllocator, sizeof(double) * size * 2);
+    if (pReal == nullptr)
+        return false;
+    double* pImag = pReal + size;
+    
+    double linearSum = 0.0;
+    for (int i = 0; i < size; ++i)
+    {
+        pReal[i] = i < in_length ? (double)in_pLinearPhase[i] : 0.0;
+        pImag[i] = 0.0;
+        if (i < in_length)
+            linearSum += pReal[i];
+    }
+    
+    // Log magnitude; the floor keeps the stopband nulls finite
+    TransformInPlace(pReal, pImag, size, false);
+    for (int i = 0; i < size; ++i)
+    {
+        double magnitude = sqrt(pReal[i] * pReal[i] + pImag[i] * pImag[i]);
+        pReal[i] = log(magnitude > 1e-9 ? magnitude : 1e-9);
+        pImag[i] = 0.0;
+    }
+    
+    // Real cepstrum, folded so that all of it is causal
+    TransformInPlace(pReal, pImag, size, true);
+    for (int i = 1; i < size / 2; ++i)
+        pReal[i] *= 2.0;
+    for (int i = size / 2 + 1; i < size; ++i)
+        pReal[i] = 0.0;
+    for (int i = 0; i < size; ++i)
+        pImag[i] = 0.0;
+    
+    // Back to a spectrum, exponentiate, back to an impulse response
+    TransformInPlace(pReal, pImag, size, false);
+    for (int i = 0; i < size; ++i)
+    {
+        double magnitude = exp(pReal[i]);
+        double phase = pImag[i];
+        pReal[i] = magnitude * cos(phase);
+        pImag[i] = magnitude * sin(phase);
+    }
+    TransformInPlace(pReal, pImag, size, true);
+    
+    double minimumSum = 0.0;
+    for (int i = 0; i < in_length; ++i)
+        minimumSum += pReal[i];
+    
+    const double gain = minimumSum != 0.0 ? linearSum / minimumSum : 1.0;
+    for (int i = 0; i < in_length; ++i)
+        out_pMinimumPhase[i] = (float)(pReal[i] * gain);
+    
+    AK_PLUGIN_FREE(in_pAllocator, pReal);
+    return true;
+}
+
+float GetFIRGroupDelay(const float* in_pCoefficients, int in_length)
+{
+    double weightedSum = 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < in_length; ++i)
+    {
+        weightedSum += (double)i * (double)in_pCoefficients[i];
+        sum += (double)in_pCoefficients[i];
+    }
+    
+    return sum != 0.0 ? (float)(weightedSum / sum) : 0.0f;
+}
+
+void DesignLowpassFIR(float* out_pCoefficients, int in_length, float in_cutoff)
+{
+    int center = in_length / 2;
+    
+    for (int i = 0; i < in_length; ++i)
+    {
+        int n = i - center;
+        if (n == 0)
+        {
+            out_pCoefficients[i] = 2.0f * in_cutoff;
+        }
+        else
+        {
+            float sinc = sinf(2.0f * FILTER_DESIGN_PI_F * in_cutoff * (float)n) / (FILTER_DESIGN_PI_F * (float)n);
+            
+            float window = 0.42f - 0.5f * cosf(2.0f * FILTER_DESIGN_PI_F * (float)i / (float)(in_length - 1))
+                         + 0.08f * cosf(4.0f * FILTER_DESIGN_PI_F * (float)i / (float)(in_length - 1));
+            
+            out_pCoefficients[i] = sinc * window;
+        }
+    }
+    
+    float sum = 0.0f;
+    for (int i = 0; i < in_length; ++i)
+        sum += out_pCoefficients[i];
+    
+    if (sum > 0.0f)
+    {
+        for (int i = 0; i < in_length; ++i)
+            out_pCoefficients[i] /= sum;
+    }
+}
+
+void DesignPowerComplementaryTable(float* out_pTable, int in_size)
+{
+    float oneOverTwoNminusOne = 1.0f / (float)((in_size - 1) << 1);
+    
+    for (int i = 0; i < in_size; ++i)
+    {
+        float val = sinf((float)i * FILTER_DESIGN_PI_F * oneOverTwoNminusOne);
+        out_pTable[i] = val * val;
+    }
+}
+
+// Half-band allpass design after the elliptic method used by de Soras' HIIR library.
+// The series are summed until their terms vanish; they converge within a handful of terms.
+static void ComputeHalfbandTransitionParams(double& k, double& q, double transition)
+{
+    k = tan((1.0 - transition * 2.0) * FILTER_DESIGN_PI / 4.0);
+    k *= k;
+    const double kksqrt = pow(1.0 - k * k, 0.25);
+    const double e = 0.5 * (1.0 - kksqrt) / (1.0 + kksqrt);
+    const double e4 = e * e * e * e;
+    q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+}
+
+static double ComputeHalfbandCoefficient(int index, double k, double q, int order)
+{
+    const double pi = FILTER_DESIGN_PI;
+    const int c = index + 1;
+    
+    double num = 0.0;
+    double sign = 1.0;
+    for (int i = 0; ; ++i, sign = -sign)
+    {
+        double term = pow(q, (double)(i * (i + 1))) * sin((double)((i * 2 + 1) * c) * pi / (double)order) * sign;
+        num += term;
+        if (fabs(term) <= 1e-100)
+            break;
+    }
+    
+    double den = 0.0;
+    sign = -1.0;
+    for (int i = 1; ; ++i, sign = -sign)
+    {
+        double term = pow(q, (double)(i * i)) * cos((double)(i * 2 * c) * pi / (double)order) * sign;
+        den += term;
+        if (fabs(term) <= 1e-100)
+            break;
+    }
+    
+    const double ww = num * pow(q, 0.25) / (den + 0.5);
+    const double wwsq = ww * ww;
+    const double x = sqrt((1.0 - wwsq * k) * (1.0 - wwsq / k)) / (1.0 + wwsq);
+    return (1.0 - x) / (1.0 + x);
+}
+
+int DesignHalfbandCascade(int in_oversampleFactor, int* out_pNumCoefs, float out_coefs[][HALFBAND_CASCADE_MAX_COEFS])
+{
+    int numStages = 0;
+    while ((2 << numStages) <= in_oversampleFactor && numStages < HALFBAND_CASCADE_MAX_STAGES)
+        ++numStages;
+    
+    // One stage per doubling, so only powers of two are supported
+    if (numStages == 0 || (1 << numStages) != in_oversampleFactor)
+        return 0;
+    
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+        // The first stage guards the whole audio band; above it the signal already
+        // occupies at most a quarter of the stage's band, so the transition can be much wider
+        int numCoefs = stage == 0 ? HALFBAND_CASCADE_MAX_COEFS : HALFBAND_CASCADE_MAX_COEFS / 2;
+        double transition = stage == 0 ? 0.04 : 0.125;
+        
+        double k, q;
+        ComputeHalfbandTransitionParams(k, q, transition);
+        for (int i = 0; i < numCoefs; ++i)
+            out_coefs[stage][i] = (float)ComputeHalfbandCoefficient(i, k, q, numCoefs * 2 + 1);
+        
+        out_pNumCoefs[stage] = numCoefs;
+    }
+    
+    return numStages;
+}
+
+// Zeroth-order modified Bessel function of the first kind, by its power series
+static double BesselI0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    const double halfX = 0.5 * x;
+    for (int k = 1; term > 1e-12 * sum; ++k)
+    {
+        term *= (halfX / (double)k) * (halfX / (double)k);
+        sum += term;
+    }
+    return sum;
+}
+
+void DesignResamplerKernels(float* out_pBank, int in_numTaps, int in_numPhases, float in_cutoff, float in_beta)
+{
+    const double halfSpan = (double)(in_numTaps / 2);
+    const double windowNorm = 1.0 / BesselI0((double)in_beta);
+    
+    for (int phase = 0; phase <= in_numPhases; ++phase)
+    {
+        float* pRow = out_pBank + phase * in_numTaps;
+        const double t = (double)phase / (double)in_numPhases;
+        
+        double sum = 0.0;
+        for (int tap = 0; tap < in_numTaps; ++tap)
+        {
+            // Distance from the read point, in samples; the window reaches zero halfSpan away
+            const double x = (double)tap - (halfSpan - 1.0) - t;
+            const double xc = FILTER_DESIGN_PI * (double)in_cutoff * x;
+            const double sinc = fabs(xc) < 1e-9 ? 1.0 : sin(xc) / xc;
+            
+            const double r = x / halfSpan;
+            const double window = r * r < 1.0 ? BesselI0((double)in_beta * sqrt(1.0 - r * r)) * windowNorm : 0.0;
+            
+            const double weight = (double)in_cutoff * sinc * window;
+            pRow[tap] = (float)weight;
+            sum += weight;
+        }
+        
+        for (int tap = 0; tap < in_numTaps; ++tap)
+            pRow[tap] = (float)((double)pRow[tap] / sum);
+    }
+}
@@ -0,0 +1,64 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef FlexibleDelayLinesFXFilterDesign_H
+#define FlexibleDelayLinesFXFilterDesign_H
+
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+// ==================== FILTER DESIGN ====================
+// Init-time helpers for the resampling filters. Nothing here runs in Execute.
+// The authoring plug-in builds this file too, to bake the tables into the bank.
+
+static constexpr int HALFBAND_CASCADE_MAX_STAGES = 4;     // Up to 16x
+static constexpr int HALFBAND_CASCADE_MAX_COEFS = 8;      // Even, so both allpass paths have the same length
+
+/// Blackman-windowed sinc lowpass normalized to unity gain at DC; in_cutoff is a fraction of the filter's rate.
+void DesignLowpassFIR(float* out_pCoefficients, int in_length, float in_cutoff);
+
+/// Gains of the power-complementary crossfade: sin^2 over a quarter period, from 0 to 1.
+void DesignPowerComplementaryTable(float* out_pTable, int in_size);
+
+/// Allpass coefficients of one half-band stage per doubling of the rate. The first stage guards
+/// the audio band with a narrow transition; the later ones get by with fewer coefficients.
+/// Returns the number of stages, or 0 when in_oversampleFactor is not a power of two up to 16.
+int DesignHalfbandCascade(int in_oversampleFactor, int* out_pNumCoefs, float out_coefs[][HALFBAND_CASCADE_MAX_COEFS]);
+
+/// Kaiser-windowed sinc kernels of the variable-ratio resampler, one per fractional position.
+/// Row p of out_pBank holds the in_numTaps weights for a read point p / in_numPhases of a sample
+/// past tap in_numTaps / 2 - 1, newest tap first; there are in_numPhases + 1 rows so that the
+/// last phase can be interpolated. in_cutoff is a fraction of Nyquist. Rows sum to 1.
+void DesignResamplerKernels(float* out_pBank, int in_numTaps, int in_numPhases, float in_cutoff, float in_beta);
+
+/// Turns a linear-phase FIR into the minimum-phase filter with the same magnitude response
+/// (homomorphic method: the real cepstrum of the log magnitude is folded onto its causal half).
+/// The DC gain is preserved. Returns false when the FFT scratch cannot be allocated.
+bool DesignMinimumPhaseFIR(const float* in_pLinearPhase, float* out_pMinimumPhase, int in_length, AK::IAkPluginMemAlloc* in_pAllocator);
+
+/// Group delay of an FIR at DC, in samples at the filter's rate.
+float GetFIRGroupDelay(const float* in_pCoefficients, int in_length);
+
+#endif // FlexibleDelayLinesFXFilterDesign_H
@@ -0,0 +1,233 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "FlexibleDelayLinesFXMemoryPool.h"
+
+FlexibleDelayLinesFXMemoryPool& FlexibleDelayLinesFXMemoryPool::Get()
+{
+    static FlexibleDelayLinesFXMemoryPool s_pool;
+    return s_pool;
+}
+
+FlexibleDelayLinesFXMemoryPool::FlexibleDelayLinesFXMemoryPool()
+    : m_numSizeClasses(0)
+    , m_uNumUsers(0)
+    , m_uBytesAllocated(0)
+    , m_pAllocator(nullptr)
+    , m_lock(0)
+{
+}
+
+void FlexibleDelayLinesFXMemoryPool::AddUser(AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    Lock();
+    if (m_uNumUsers++ == 0)
+        m_pAllocator = in_pAllocator;
+    Unlock();
+}
+
+void FlexibleDelayLinesFXMemoryPool::RemoveUser()
+{
+    Lock();
+    if (m_uNumUsers == 0 || --m_uNumUsers > 0)
+    {
+        Unlock();
+        return;
+    }
+
+    // Last instance gone: hand the cached blocks back to the sound engine
+    FreeBlock* pBlocks = DetachCache((size_t)FLEXIBLEDELAYLINES_POOL_BUDGET + 1, false);
+    AK::IAkPluginMemAlloc* pAllocator = m_pAllocator;
+    m_numSizeClasses = 0;
+    m_pAllocator = nullptr;
+    Unlock();
+
+    FreeBlocks(pBlocks, pAllocator);
+}
+
+bool FlexibleDelayLinesFXMemoryPool::Reserve(AkUInt32 in_uBlockSize, AkUInt32 in_uNumBlocks)
+{
+    Lock();
+    SizeClass* pSizeClass = m_pAllocator != nullptr ? AddSizeClass(in_uBlockSize) : nullptr;
+    if (pSizeClass == nullptr)
+    {
+        Unlock();
+        return false;
+    }
+
+    pSizeClass->uNumReserved += in_uNumBlocks;
+    AkUInt32 uNumMissing = pSizeClass->uNumBlocks < pSizeClass->uNumReserved
+        ? pSizeClass->uNumReserved - pSizeClass->uNumBlocks : 0;
+
+    // Make room by dropping cached blocks nobody reserved, then claim the budget and the
+    // blocks up front so that concurrent reservations cannot overshoot either together
+    FreeBlock* pTrimmed = DetachCache((size_t)uNumMissing * in_uBlockSize, true);
+    const size_t uAvailable = (size_t)FLEXIBLEDELAYLINES_POOL_BUDGET - m_uBytesAllocated;
+    if ((size_t)uNumMissing * in_uBlockSize > uAvailable)
+        uNumMissing = (AkUInt32)(uAvailable / in_uBlockSize);
+    m_uBytesAllocated += (size_t)uNumMissing * in_uBlockSize;
+    pSizeClass->uNumBlocks += uNumMissing;
+    AK::IAkPluginMemAlloc* pAllocator = m_pAllocator;
+    Unlock();
+
+    // The allocator runs outside the lock, so Execute on other threads never waits on it
+    FreeBlocks(pTrimmed, pAllocator);
+
+    FreeBlock* pNewBlocks = nullptr;
+    FreeBlock* pLastNewBlock = nullptr;
+    AkUInt32 uNumAllocated = 0;
+    for (; uNumAllocated < uNumMissing; ++uNumAllocated)
+    {
+        FreeBlock* pBlock = (FreeBlock*)AK_PLUGIN_ALLOC(pAllocator, in_uBlockSize);
+        if (pBlock == nullptr)
+            break;
+
+        pBlock->pNext = pNewBlocks;
+        pBlock->uBlockSize = in_uBlockSize;
+        pNewBlocks = pBlock;
+        if (pLastNewBlock == nullptr)
+            pLastNewBlock = pBlock;
+    }
+
+    Lock();
+    m_uBytesAllocated -= (size_t)(uNumMissing - uNumAllocated) * in_uBlockSize;
+    pSizeClass->uNumBlocks -= uNumMissing - uNumAllocated;
+    if (pLastNewBlock != nullptr)
+    {
+        pLastNewBlock->pNext = pSizeClass->pFreeList;
+        pSizeClass->pFreeList = pNewBlocks;
+        pSizeClass->uNumFree += uNumAllocated;
+    }
+    const bool bReserved = pSizeClass->uNumBlocks >= pSizeClass->uNumReserved;
+    Unlock();
+
+    return bReserved;
+}
+
+void FlexibleDelayLinesFXMemoryPool::Unreserve(AkUInt32 in_uBlockSize, AkUInt32 in_uNumBlocks)
+{
+    Lock();
+    SizeClass* pSizeClass = FindSizeClass(in_uBlockSize);
+    if (pSizeClass != nullptr)
+        pSizeClass->uNumReserved -= in_uNumBlocks < pSizeClass->uNumReserved ? in_uNumBlocks : pSizeClass->uNumReserved;
+    Unlock();
+}
+
+FlexibleDelayLinesFXMemoryPool::FreeBlock* FlexibleDelayLinesFXMemoryPool::DetachCache(size_t in_uBytesNeeded, bool in_bKeepReserved)
+{
+    FreeBlock* pDetached = nullptr;
+    for (int i = 0; i < m_numSizeClasses; ++i)
+    {
+        SizeClass& sizeClass = m_sizeClasses[i];
+
+        // Free blocks another object counts on stay, even when that object is quiet now
+        while (sizeClass.pFreeList != nullptr
+            && (!in_bKeepReserved || sizeClass.uNumBlocks > sizeClass.uNumReserved)
+            && m_uBytesAllocated + in_uBytesNeeded > (size_t)FLEXIBLEDELAYLINES_POOL_BUDGET)
+        {
+            FreeBlock* pBlock = sizeClass.pFreeList;
+            sizeClass.pFreeList = pBlock->pNext;
+            --sizeClass.uNumFree;
+            --sizeClass.uNumBlocks;
+            m_uBytesAllocated -= sizeClass.uBlockSize;
+
+            pBlock->pNext = pDetached;
+            pDetached = pBlock;
+        }
+    }
+    return pDetached;
+}
+
+void FlexibleDelayLinesFXMemoryPool::FreeBlocks(FreeBlock* in_pBlocks, AK::IAkPluginMemAlloc* in_pAllocator)
+{
+    while (in_pBlocks != nullptr)
+    {
+        FreeBlock* pBlock = in_pBlocks;
+        in_pBlocks = pBlock->pNext;
+        AK_PLUGIN_FREE(in_pAllocator, pBlock);
+    }
+}
+
+FlexibleDelayLinesFXMemoryPool::SizeClass* FlexibleDelayLinesFXMemoryPool::FindSizeClass(AkUInt32 in_uBlockSize)
+{
+    for (int i = 0; i < m_numSizeClasses; ++i)
+    {
+        if (m_sizeClasses[i].uBlockSize == in_uBlockSize)
+            return &m_sizeClasses[i];
+    }
+    return nullptr;
+}
+
+FlexibleDelayLinesFXMemoryPool::SizeClass* FlexibleDelayLinesFXMemoryPool::AddSizeClass(AkUInt32 in_uBlockSize)
+{
+    SizeClass* pSizeClass = FindSizeClass(in_uBlockSize);
+    if (pSizeClass != nullptr || m_numSizeClasses == MAX_SIZE_CLASSES)
+        return pSizeClass;
+
+    SizeClass& sizeClass = m_sizeClasses[m_numSizeClasses++];
+    sizeClass.uBlockSize = in_uBlockSize;
+    sizeClass.uNumBlocks = 0;
+    sizeClass.uNumReserved = 0;
+    sizeClass.uNumFree = 0;
+    sizeClass.pFreeList = nullptr;
+    return &sizeClass;
+}
+
+void* FlexibleDelayLinesFXMemoryPool::Acquire(AkUInt32 in_uBlockSize)
+{
+    // Busy counts as empty: the caller passes the dry signal through and tries again next buffer
+    if (!TryLock())
+        return nullptr;
+
+    FreeBlock* pBlock = nullptr;
+    SizeClass* pSizeClass = FindSizeClass(in_uBlockSize);
+    if (pSizeClass != nullptr && pSizeClass->pFreeList != nullptr)
+    {
+        pBlock = pSizeClass->pFreeList;
+        pSizeClass->pFreeList = pBlock->pNext;
+        --pSizeClass->uNumFree;
+    }
+    Unlock();
+    return pBlock;
+}
+
+void FlexibleDelayLinesFXMemoryPool::Release(void* in_pBlock, AkUInt32 in_uBlockSize)
+{
+    if (in_pBlock == nullptr)
+        return;
+
+    // Every block came from Reserve, so its size class exists
+    Lock();
+    SizeClass* pSizeClass = FindSizeClass(in_uBlockSize);
+    AKASSERT(pSizeClass != nullptr);
+
+    FreeBlock* pBlock = (FreeBlock*)in_pBlock;
+    pBlock->uBlockSize = in_uBlockSize;
+    pBlock->pNext = pSizeClass->pFreeList;
+    pSizeClass->pFreeList = pBlock;
+    ++pSizeClass->uNumFree;
+    Unlock();
+}
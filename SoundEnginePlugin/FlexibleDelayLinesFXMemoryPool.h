@@ -0,0 +1,112 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef FlexibleDelayLinesFXMemoryPool_H
+#define FlexibleDelayLinesFXMemoryPool_H
+
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+#include <AK/Tools/Common/AkAtomic.h>
+
+// Upper bound on the memory the pool holds from the sound engine, cached blocks included
+#ifndef FLEXIBLEDELAYLINES_POOL_BUDGET
+#define FLEXIBLEDELAYLINES_POOL_BUDGET (128 * 1024 * 1024)
+#endif
+
+/// Process-wide pool of delay memory blocks shared by every FlexibleDelayLinesFX instance.
+/// Blocks are grouped by size; released blocks are kept on a free list and handed back
+/// out, so memory tracks the peak number of blocks in use at once rather than the number
+/// of instances. The total never exceeds FLEXIBLEDELAYLINES_POOL_BUDGET; cached blocks of
+/// other sizes are freed to make room.
+///
+/// Only Reserve allocates, from Init; Acquire and Release run in Execute and never allocate
+/// or wait on the allocator. A spin lock guards the free lists for a few pointer moves at a
+/// time: Acquire only tries it once and reports failure when it is taken, as when the list is empty.
+class FlexibleDelayLinesFXMemoryPool
+{
+public:
+    static FlexibleDelayLinesFXMemoryPool& Get();
+
+    /// Registers an instance. Must be balanced by RemoveUser().
+    /// Every instance receives the sound engine's plug-in allocator, so the pool grows from it.
+    void AddUser(AK::IAkPluginMemAlloc* in_pAllocator);
+
+    /// Unregisters an instance. The last user returns every cached block to the allocator.
+    void RemoveUser();
+
+    /// Adds in_uNumBlocks blocks of in_uBlockSize bytes to the reservations and allocates
+    /// until the pool holds that many blocks of the size, free or in use. Stops at the budget.
+    /// Must be balanced by Unreserve(), even when it returns false.
+    /// Returns true when every block reserved for that size is there.
+    bool Reserve(AkUInt32 in_uBlockSize, AkUInt32 in_uNumBlocks);
+
+    /// Takes back a reservation. The blocks stay cached until another size needs the room.
+    void Unreserve(AkUInt32 in_uBlockSize, AkUInt32 in_uNumBlocks);
+
+    /// Takes a free block of in_uBlockSize bytes. Returns nullptr when none is free or another
+    /// thread holds the lists; never allocates. The content is undefined.
+    void* Acquire(AkUInt32 in_uBlockSize);
+
+    /// Gives a block back to the pool.
+    void Release(void* in_pBlock, AkUInt32 in_uBlockSize);
+
+private:
+    FlexibleDelayLinesFXMemoryPool();
+
+    struct FreeBlock
+    {
+        FreeBlock* pNext;
+        AkUInt32 uBlockSize;
+    };
+
+    struct SizeClass
+    {
+        AkUInt32 uBlockSize;
+        AkUInt32 uNumBlocks;          // Allocated, free or in use
+        AkUInt32 uNumReserved;        // Sum of the objects' reservations
+        AkUInt32 uNumFree;
+        FreeBlock* pFreeList;
+    };
+
+    SizeClass* FindSizeClass(AkUInt32 in_uBlockSize);
+    SizeClass* AddSizeClass(AkUInt32 in_uBlockSize);
+    FreeBlock* DetachCache(size_t in_uBytesNeeded, bool in_bKeepReserved);
+    void FreeBlocks(FreeBlock* in_pBlocks, AK::IAkPluginMemAlloc* in_pAllocator);
+
+    inline bool TryLock() { return AkAtomicCas32(&m_lock, 1, 0); }
+    inline void Lock() { while (!TryLock()) {} }
+    inline void Unlock() { AkAtomicStore32(&m_lock, 0); }
+
+    static constexpr int MAX_SIZE_CLASSES = 16;
+
+    SizeClass m_sizeClasses[MAX_SIZE_CLASSES];
+    int m_numSizeClasses;
+    AkUInt32 m_uNumUsers;
+    size_t m_uBytesAllocated;
+    AK::IAkPluginMemAlloc* m_pAllocator;
+    AkAtomic32 m_lock;
+};
+
+#endif // FlexibleDelayLinesFXMemoryPool_H
@@ -28,8 +28,16 @@ the specific language governing permissions and limitations under the License.
 
 #include <AK/Tools/Common/AkBankReadHelpers.h>
 
+#include <string.h>
+
 FlexibleDelayLinesFXParams::FlexibleDelayLinesFXParams()
+    : uDelayCurveVersion(0)
+    , bHasFilterTables(false)
+    , m_uSequence(0)
+    , m_uConsumedSequence(0)
 {
+    DelayCurve.uValueType = DELAY_CURVE_DELAYTIME;
+    DelayCurve.uNumPoints = 0;
 }
 
 FlexibleDelayLinesFXParams::~FlexibleDelayLinesFXParams()
@@ -37,10 +45,18 @@ FlexibleDelayLinesFXParams::~FlexibleDelayLinesFXParams()
 }
 
 FlexibleDelayLinesFXParams::FlexibleDelayLinesFXParams(const FlexibleDelayLinesFXParams& in_rParams)
+    : m_uSequence(0)
+    , m_uConsumedSequence(0)
 {
     RTPC = in_rParams.RTPC;
     NonRTPC = in_rParams.NonRTPC;
+    DelayCurve = in_rParams.DelayCurve;
+    uDelayCurveVersion = in_rParams.uDelayCurveVersion;
+    bHasFilterTables = in_rParams.bHasFilterTables;
+    if (bHasFilterTables)
+        FilterTables = in_rParams.FilterTables;
     m_paramChangeHandler.SetAllParamChanges();
+    Publish();
 }
 
 AK::IAkPluginParam* FlexibleDelayLinesFXParams::Clone(AK::IAkPluginMemAlloc* in_pAllocator)
@@ -57,12 +73,31 @@ AKRESULT FlexibleDelayLinesFXParams::Init(AK::IAkPluginMemAlloc* in_pAllocator,
         RTPC.fWetDryMix = 1.0f;
         RTPC.fFeedback = 0.0f;
         RTPC.fDistance = 10.0f;
+        RTPC.fDelaySpread = 0.5f;
+        RTPC.fDampingLowpass = 20000.0f;
+        RTPC.fDampingHighpass = 0.0f;
+        RTPC.fReferenceDistance = 1.0f;
+        RTPC.fJumpThreshold = 0.0f;
+        RTPC.fCrossfadeTime = 50.0f;
         
         NonRTPC.interpolationType = 0;
         NonRTPC.oversamplingFactor = 1;
         NonRTPC.upsamplingMethod = 0;
+        NonRTPC.storageFormat = 0;
+        NonRTPC.delayMemoryMode = 0;
+        NonRTPC.decimationFactor = 1;
+        NonRTPC.filterPhase = 0;
+        NonRTPC.distanceSource = 0;
+        NonRTPC.listenerIndex = 0;
+        NonRTPC.feedbackMatrix = 0;
+        NonRTPC.dcBlocker = 0;
+        NonRTPC.distanceEffects = 0;
+        NonRTPC.virtualSnapshot = 0;
+        NonRTPC.maxDelayTime = 0;
+        NonRTPC.bandSplitCrossover = 0;
         
         m_paramChangeHandler.SetAllParamChanges();
+        Publish();
         return AK_Success;
     }
 
@@ -79,19 +114,48 @@ AKRESULT FlexibleDelayLinesFXParams::SetParamsBlock(const void* in_pParamsBlock,
 {
     AKRESULT eResult = AK_Success;
     AkUInt8* pParamsBlock = (AkUInt8*)in_pParamsBlock;
+    const bool bHasTail = in_ulBlockSize > sizeof(AkReal32) * 10 + sizeof(AkUInt32) * 15;
+    BeginChange();
 
     // Read bank data here
     RTPC.fDelayTime = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fWetDryMix = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fFeedback = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     RTPC.fDistance = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fDelaySpread = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fDampingLowpass = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fDampingHighpass = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fReferenceDistance = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fJumpThreshold = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    RTPC.fCrossfadeTime = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
     
     NonRTPC.interpolationType = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
     NonRTPC.oversamplingFactor = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
     NonRTPC.upsamplingMethod = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.storageFormat = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.delayMemoryMode = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.decimationFactor = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.filterPhase = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.distanceSource = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.listenerIndex = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.feedbackMatrix = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.dcBlocker = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.distanceEffects = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.virtualSnapshot = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.maxDelayTime = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.bandSplitCrossover = READBANKDATA(AkUInt32, pParamsBlock, in_ulBlockSize);
+    
+    // Whatever follows the scalars is the baked filter tables; a tail this build cannot use is skipped
+    bHasFilterTables = false;
+    if (bHasTail)
+    {
+        bHasFilterTables = ReadFilterTables(pParamsBlock, in_ulBlockSize);
+        in_ulBlockSize = 0;
+    }
     
     CHECKBANKDATASIZE(in_ulBlockSize, eResult);
     m_paramChangeHandler.SetAllParamChanges();
+    Publish();
 
     return eResult;
 }
@@ -99,6 +163,7 @@ AKRESULT FlexibleDelayLinesFXParams::SetParamsBlock(const void* in_pParamsBlock,
 AKRESULT FlexibleDelayLinesFXParams::SetParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize)
 {
     AKRESULT eResult = AK_Success;
+    BeginChange();
 
     // Handle parameter change here
     switch (in_paramID)
@@ -119,6 +184,30 @@ AKRESULT FlexibleDelayLinesFXParams::SetParam(AkPluginParamID in_paramID, const
         RTPC.fDistance = *((AkReal32*)in_pValue);
         m_paramChangeHandler.SetParamChange(PARAM_DISTANCE_ID);
         break;
+    case PARAM_DELAYSPREAD_ID:
+        RTPC.fDelaySpread = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DELAYSPREAD_ID);
+        break;
+    case PARAM_DAMPINGLOWPASS_ID:
+        RTPC.fDampingLowpass = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DAMPINGLOWPASS_ID);
+        break;
+    case PARAM_DAMPINGHIGHPASS_ID:
+        RTPC.fDampingHighpass = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DAMPINGHIGHPASS_ID);
+        break;
+    case PARAM_REFERENCEDISTANCE_ID:
+        RTPC.fReferenceDistance = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_REFERENCEDISTANCE_ID);
+        break;
+    case PARAM_JUMPTHRESHOLD_ID:
+        RTPC.fJumpThreshold = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_JUMPTHRESHOLD_ID);
+        break;
+    case PARAM_CROSSFADETIME_ID:
+        RTPC.fCrossfadeTime = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_CROSSFADETIME_ID);
+        break;
     case PARAM_INTERPOLATIONTYPE_ID:
         NonRTPC.interpolationType = *((AkUInt32*)in_pValue);
         m_paramChangeHandler.SetParamChange(PARAM_INTERPOLATIONTYPE_ID);
@@ -131,10 +220,221 @@ AKRESULT FlexibleDelayLinesFXParams::SetParam(AkPluginParamID in_paramID, const
         NonRTPC.upsamplingMethod = *((AkUInt32*)in_pValue);
         m_paramChangeHandler.SetParamChange(PARAM_UPSAMPLINGMETHOD_ID);
         break;
+    case PARAM_STORAGEFORMAT_ID:
+        NonRTPC.storageFormat = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_STORAGEFORMAT_ID);
+        break;
+    case PARAM_DELAYMEMORYMODE_ID:
+        NonRTPC.delayMemoryMode = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DELAYMEMORYMODE_ID);
+        break;
+    case PARAM_DECIMATIONFACTOR_ID:
+        NonRTPC.decimationFactor = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DECIMATIONFACTOR_ID);
+        break;
+    case PARAM_FILTERPHASE_ID:
+        NonRTPC.filterPhase = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_FILTERPHASE_ID);
+        break;
+    case PARAM_DISTANCESOURCE_ID:
+        NonRTPC.distanceSource = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DISTANCESOURCE_ID);
+        break;
+    case PARAM_LISTENERINDEX_ID:
+        NonRTPC.listenerIndex = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_LISTENERINDEX_ID);
+        break;
+    case PARAM_FEEDBACKMATRIX_ID:
+        NonRTPC.feedbackMatrix = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_FEEDBACKMATRIX_ID);
+        break;
+    case PARAM_DCBLOCKER_ID:
+        NonRTPC.dcBlocker = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DCBLOCKER_ID);
+        break;
+    case PARAM_DISTANCEEFFECTS_ID:
+        NonRTPC.distanceEffects = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_DISTANCEEFFECTS_ID);
+        break;
+    case PARAM_VIRTUALSNAPSHOT_ID:
+        NonRTPC.virtualSnapshot = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_VIRTUALSNAPSHOT_ID);
+        break;
+    case PARAM_MAXDELAYTIME_ID:
+        NonRTPC.maxDelayTime = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_MAXDELAYTIME_ID);
+        break;
+    case PARAM_BANDSPLITCROSSOVER_ID:
+        NonRTPC.bandSplitCrossover = *((AkUInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PARAM_BANDSPLITCROSSOVER_ID);
+        break;
+    case PARAM_DELAYCURVE_ID:
+        eResult = SetDelayCurve(in_pValue, in_ulParamSize);
+        if (eResult == AK_Success)
+            m_paramChangeHandler.SetParamChange(PARAM_DELAYCURVE_ID);
+        break;
     default:
         eResult = AK_InvalidParameter;
         break;
     }
 
+    if (eResult == AK_Success)
+        Publish();
+
     return eResult;
 }
+
+void FlexibleDelayLinesFXParams::BeginChange()
+{
+    // Once the reader holds the latest version, the flags it came with are stale.
+    // Missing its acknowledgement by a hair only reports a change twice.
+    if (AkAtomicLoad32(&m_uConsumedSequence) == AkAtomicLoad32(&m_uSequence))
+        m_paramChangeHandler.ResetAllParamChanges();
+}
+
+void FlexibleDelayLinesFXParams::Publish()
+{
+    const AkInt32 sequence = AkAtomicLoad32(&m_uSequence);
+    AkAtomicStore32(&m_uSequence, sequence + 1);
+    AkMemoryBarrier();
+    
+    m_published.RTPC = RTPC;
+    m_published.NonRTPC = NonRTPC;
+    m_published.DelayCurve = DelayCurve;
+    m_published.uDelayCurveVersion = uDelayCurveVersion;
+    m_published.changes = m_paramChangeHandler;
+    
+    AkMemoryBarrier();
+    AkAtomicStore32(&m_uSequence, sequence + 2);
+}
+
+bool FlexibleDelayLinesFXParams::ReadSnapshot(FlexibleDelayLinesParamsSnapshot& out_snapshot, AkUInt32& io_uSequence, int in_maxAttempts)
+{
+    // Torn copies land here, never in the caller's snapshot
+    FlexibleDelayLinesParamsSnapshot snapshot;
+    for (int attempt = 0; attempt < in_maxAttempts; ++attempt)
+    {
+        const AkUInt32 uSequence = (AkUInt32)AkAtomicLoad32(&m_uSequence);
+        if (uSequence == io_uSequence)
+            return false;
+        if (uSequence & 1)
+            continue;
+        
+        AkMemoryBarrier();
+        snapshot = m_published;
+        AkMemoryBarrier();
+        
+        // A publish started during the copy: the copy may mix two versions
+        if ((AkUInt32)AkAtomicLoad32(&m_uSequence) != uSequence)
+            continue;
+        
+        out_snapshot = snapshot;
+        io_uSequence = uSequence;
+        AkAtomicStore32(&m_uConsumedSequence, (AkInt32)uSequence);
+        return true;
+    }
+    
+    return false;
+}
+
+void FlexibleDelayLinesFXParams::ReadSnapshotUnchecked(FlexibleDelayLinesParamsSnapshot& out_snapshot, AkUInt32& io_uSequence)
+{
+    const AkUInt32 uSequence = (AkUInt32)AkAtomicLoad32(&m_uSequence);
+    AkMemoryBarrier();
+    out_snapshot = m_published;
+    AkMemoryBarrier();
+    
+    // Odd never matches a finished publish, and the change flags stay set for the next reader
+    io_uSequence = uSequence | 1;
+}
+
+AKRESULT FlexibleDelayLinesFXParams::SetDelayCurve(const void* in_pValue, AkUInt32 in_ulParamSize)
+{
+    const AkUInt32 headerSize = sizeof(AkUInt32) * 2;
+    if (in_pValue == nullptr || in_ulParamSize < headerSize)
+        return AK_InvalidParameter;
+    
+    FlexibleDelayLinesDelayCurve curve;
+    memcpy(&curve, in_pValue, headerSize);
+    
+    if (curve.uValueType > DELAY_CURVE_DISTANCE
+        || curve.uNumPoints == 0
+        || curve.uNumPoints > DELAY_CURVE_MAX_POINTS
+        || in_ulParamSize != headerSize + curve.uNumPoints * sizeof(FlexibleDelayLinesCurvePoint))
+    {
+        return AK_InvalidParameter;
+    }
+    
+    memcpy(curve.points, (const AkUInt8*)in_pValue + headerSize, curve.uNumPoints * sizeof(FlexibleDelayLinesCurvePoint));
+    
+    // Times must increase strictly and values stay non-negative (NaN fails both)
+    for (AkUInt32 i = 0; i < curve.uNumPoints; ++i)
+    {
+        bool bIncreasing = i == 0 ? curve.points[i].fTime >= 0.0f : curve.points[i].fTime > curve.points[i - 1].fTime;
+        if (!bIncreasing || !(curve.points[i].fValue >= 0.0f))
+            return AK_InvalidParameter;
+    }
+    
+    DelayCurve = curve;
+    ++uDelayCurveVersion;
+    return AK_Success;
+}
+
+// Bounds-checked reads for the tables tail: unlike the scalars, its layout depends on what it holds
+static bool ReadTableUInt32(AkUInt8*& io_pData, AkUInt32& io_ulSize, AkUInt32& out_uValue)
+{
+    if (io_ulSize < sizeof(AkUInt32))
+        return false;
+    out_uValue = READBANKDATA(AkUInt32, io_pData, io_ulSize);
+    return true;
+}
+
+static bool ReadTableReals(AkUInt8*& io_pData, AkUInt32& io_ulSize, AkReal32* out_pValues, AkUInt32 in_uCount)
+{
+    if (io_ulSize < sizeof(AkReal32) * in_uCount)
+        return false;
+    for (AkUInt32 i = 0; i < in_uCount; ++i)
+        out_pValues[i] = READBANKDATA(AkReal32, io_pData, io_ulSize);
+    return true;
+}
+
+bool FlexibleDelayLinesFXParams::ReadFilterTables(AkUInt8* in_pTail, AkUInt32 in_ulTailSize)
+{
+    FlexibleDelayLinesFilterTables& tables = FilterTables;
+    AkUInt32 uTag = 0;
+    AkUInt32 uVersion = 0;
+    if (!ReadTableUInt32(in_pTail, in_ulTailSize, uTag) || uTag != FILTER_TABLES_TAG
+        || !ReadTableUInt32(in_pTail, in_ulTailSize, uVersion) || uVersion != FILTER_TABLES_VERSION)
+        return false;
+    
+    if (!ReadTableUInt32(in_pTail, in_ulTailSize, tables.uOversampleFactor)
+        || !ReadTableUInt32(in_pTail, in_ulTailSize, tables.uUpsamplingMethod)
+        || !ReadTableUInt32(in_pTail, in_ulTailSize, tables.uFilterPhase)
+        || !ReadTableUInt32(in_pTail, in_ulTailSize, tables.uDecimationFactor)
+        || !ReadTableReals(in_pTail, in_ulTailSize, tables.powerComplementary, FILTER_TABLES_POWERCOMP_LEN))
+        return false;
+    
+    if (!ReadTableUInt32(in_pTail, in_ulTailSize, tables.uFIRLength)
+        || tables.uFIRLength > FILTER_TABLES_MAX_FIR_LEN
+        || !ReadTableReals(in_pTail, in_ulTailSize, tables.fir, tables.uFIRLength))
+        return false;
+    
+    if (!ReadTableUInt32(in_pTail, in_ulTailSize, tables.uHalfbandNumStages)
+        || tables.uHalfbandNumStages > FILTER_TABLES_MAX_HALFBAND_STAGES)
+        return false;
+    for (AkUInt32 stage = 0; stage < tables.uHalfbandNumStages; ++stage)
+    {
+        if (!ReadTableUInt32(in_pTail, in_ulTailSize, tables.halfbandNumCoefs[stage])
+            || tables.halfbandNumCoefs[stage] == 0
+            || tables.halfbandNumCoefs[stage] > FILTER_TABLES_MAX_HALFBAND_COEFS
+            || !ReadTableReals(in_pTail, in_ulTailSize, tables.halfbandCoefs[stage], tables.halfbandNumCoefs[stage]))
+            return false;
+    }
+    
+    if (!ReadTableUInt32(in_pTail, in_ulTailSize, tables.uDecimationFIRLength)
+        || tables.uDecimationFIRLength > FILTER_TABLES_MAX_DECIMATION_FIR_LEN
+        || !ReadTableReals(in_pTail, in_ulTailSize, tables.decimationFIR, tables.uDecimationFIRLength))
+        return false;
+    
+    return in_ulTailSize == 0;
+}
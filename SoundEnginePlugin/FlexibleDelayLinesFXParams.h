@@ -29,6 +29,7 @@ the specific language governing permissions and limitations under the License.
 
 #include <AK/SoundEngine/Common/IAkPlugin.h>
 #include <AK/Plugin/PluginServices/AkFXParameterChangeHandler.h>
+#include <AK/Tools/Common/AkAtomic.h>
 
 // Parameter IDs
 static const AkPluginParamID PARAM_DELAYTIME_ID = 0;
@@ -38,8 +39,27 @@ static const AkPluginParamID PARAM_DISTANCE_ID = 3;
 static const AkPluginParamID PARAM_INTERPOLATIONTYPE_ID = 4;
 static const AkPluginParamID PARAM_OVERSAMPLINGFACTOR_ID = 5;
 static const AkPluginParamID PARAM_UPSAMPLINGMETHOD_ID = 6;
-
-static const AkUInt32 NUM_PARAMS = 7;
+static const AkPluginParamID PARAM_STORAGEFORMAT_ID = 7;
+static const AkPluginParamID PARAM_DELAYMEMORYMODE_ID = 8;
+static const AkPluginParamID PARAM_DECIMATIONFACTOR_ID = 9;
+static const AkPluginParamID PARAM_FILTERPHASE_ID = 10;
+static const AkPluginParamID PARAM_DELAYCURVE_ID = 11;    // SetParam only, never in banks
+static const AkPluginParamID PARAM_DISTANCESOURCE_ID = 12;
+static const AkPluginParamID PARAM_LISTENERINDEX_ID = 13;
+static const AkPluginParamID PARAM_FEEDBACKMATRIX_ID = 14;
+static const AkPluginParamID PARAM_DELAYSPREAD_ID = 15;
+static const AkPluginParamID PARAM_DAMPINGLOWPASS_ID = 16;
+static const AkPluginParamID PARAM_DAMPINGHIGHPASS_ID = 17;
+static const AkPluginParamID PARAM_DCBLOCKER_ID = 18;
+static const AkPluginParamID PARAM_DISTANCEEFFECTS_ID = 19;
+static const AkPluginParamID PARAM_REFERENCEDISTANCE_ID = 20;
+static const AkPluginParamID PARAM_JUMPTHRESHOLD_ID = 21;
+static const AkPluginParamID PARAM_CROSSFADETIME_ID = 22;
+static const AkPluginParamID PARAM_VIRTUALSNAPSHOT_ID = 23;
+static const AkPluginParamID PARAM_MAXDELAYTIME_ID = 24;
+static const AkPluginParamID PARAM_BANDSPLITCROSSOVER_ID = 25;
+
+static const AkUInt32 NUM_PARAMS = 26;
 
 struct FlexibleDelayLinesRTPCParams
 {
@@ -47,6 +67,12 @@ struct FlexibleDelayLinesRTPCParams
     AkReal32 fWetDryMix;   // Wet/Dry Mix in percentage
     AkReal32 fFeedback;    // Feedback in percentage
     AkReal32 fDistance;    // Distance in meters for automatic delay time calculation
+    AkReal32 fDelaySpread; // FDN only: how far apart the line delays are, 0 to 1
+    AkReal32 fDampingLowpass;  // Feedback lowpass cutoff in Hz, off at 20 kHz
+    AkReal32 fDampingHighpass; // Feedback highpass cutoff in Hz, off at 0
+    AkReal32 fReferenceDistance; // Distance in meters below which the attenuation is 0 dB
+    AkReal32 fJumpThreshold;   // Delay change rate (seconds per second) above which the delay crossfades, off at 0
+    AkReal32 fCrossfadeTime;   // Crossfade length in milliseconds
 };
 
 struct FlexibleDelayLinesNonRTPCParams
@@ -54,6 +80,102 @@ struct FlexibleDelayLinesNonRTPCParams
     AkUInt32 interpolationType;    // Interpolation method
     AkUInt32 oversamplingFactor;   // Oversampling factor
     AkUInt32 upsamplingMethod;     // Upsampling method
+    AkUInt32 storageFormat;        // Delay ring sample format
+    AkUInt32 delayMemoryMode;      // Contiguous, paged or pooled delay memory
+    AkUInt32 decimationFactor;     // Rate reduction of the delay loop
+    AkUInt32 filterPhase;          // Linear or minimum phase oversampling FIR
+    AkUInt32 distanceSource;       // Distance RTPC, emitter-listener distance or audio object position
+    AkUInt32 listenerIndex;        // Emitter-listener pair followed by the listener index source
+    AkUInt32 feedbackMatrix;       // Per-channel feedback, or an FDN mixing the channels' feedback
+    AkUInt32 dcBlocker;            // Removes DC from the feedback signal
+    AkUInt32 distanceEffects;      // Air absorption and/or attenuation on the delayed signal
+    AkUInt32 virtualSnapshot;      // Keeps the delay tail of a virtual voice in a compact snapshot
+    AkUInt32 maxDelayTime;         // Longest delay the instance is used at in ms, 0 when unknown
+    AkUInt32 bandSplitCrossover;   // Hz below which oversampling leaves the signal to the base-rate ring, 0 for the full band
+};
+
+// ==================== DELAY CURVE ====================
+// A short timestamped trajectory for the delay, sent by the game with SetParam(PARAM_DELAYCURVE_ID)
+// instead of streaming RTPC updates. The blob is the struct below truncated after uNumPoints points.
+// Times are in seconds from the next audio buffer and must increase strictly; the delay is
+// interpolated with cubic segments from its current value, then holds the last point until
+// another curve arrives or the Delay Time / Distance RTPCs change.
+
+static const AkUInt32 DELAY_CURVE_MAX_POINTS = 16;
+
+enum DelayCurveValueType
+{
+    DELAY_CURVE_DELAYTIME = 0,     // Values in seconds
+    DELAY_CURVE_DISTANCE = 1       // Values in meters, mapped like the Distance parameter
+};
+
+struct FlexibleDelayLinesCurvePoint
+{
+    AkReal32 fTime;
+    AkReal32 fValue;
+};
+
+struct FlexibleDelayLinesDelayCurve
+{
+    AkUInt32 uValueType;
+    AkUInt32 uNumPoints;
+    FlexibleDelayLinesCurvePoint points[DELAY_CURVE_MAX_POINTS];
+};
+
+// ==================== BAKED FILTER TABLES ====================
+// The authoring plug-in designs the resampling filters and the crossfade table for the settings
+// an instance will run with and appends them to the bank block, so that Init copies them instead
+// of evaluating sines, Bessel-free elliptic series and FFTs on the voice start. The tail is
+// versioned: a block without it, or with a tag or version this build does not know, still loads
+// and the filters are designed at Init as before.
+
+static const AkUInt32 FILTER_TABLES_TAG = 0x54444C46;     // "FDLT"
+static const AkUInt32 FILTER_TABLES_VERSION = 1;
+static const AkUInt32 FILTER_TABLES_POWERCOMP_LEN = 256;
+static const AkUInt32 FILTER_TABLES_MAX_FIR_LEN = 128;            // 8 taps per phase at 16x
+static const AkUInt32 FILTER_TABLES_MAX_HALFBAND_STAGES = 4;
+static const AkUInt32 FILTER_TABLES_MAX_HALFBAND_COEFS = 8;
+static const AkUInt32 FILTER_TABLES_MAX_DECIMATION_FIR_LEN = 65;  // 16 taps per phase at 4x, plus one
+
+struct FlexibleDelayLinesFilterTables
+{
+    // Effective settings the tables were designed for; Init designs its own when they differ
+    AkUInt32 uOversampleFactor;
+    AkUInt32 uUpsamplingMethod;
+    AkUInt32 uFilterPhase;
+    AkUInt32 uDecimationFactor;
+
+    AkReal32 powerComplementary[FILTER_TABLES_POWERCOMP_LEN];
+
+    AkUInt32 uFIRLength;           // 0 unless the polyphase FIR is used
+    AkReal32 fir[FILTER_TABLES_MAX_FIR_LEN];
+
+    AkUInt32 uHalfbandNumStages;   // 0 unless the half-band cascade is used
+    AkUInt32 halfbandNumCoefs[FILTER_TABLES_MAX_HALFBAND_STAGES];
+    AkReal32 halfbandCoefs[FILTER_TABLES_MAX_HALFBAND_STAGES][FILTER_TABLES_MAX_HALFBAND_COEFS];
+
+    AkUInt32 uDecimationFIRLength; // 0 unless the loop is decimated
+    AkReal32 decimationFIR[FILTER_TABLES_MAX_DECIMATION_FIR_LEN];
+};
+
+// ==================== SNAPSHOT ====================
+// SetParam and SetParamsBlock may run on another thread than Execute. They edit the working copy
+// in FlexibleDelayLinesFXParams, then publish it whole; Execute copies the latest published
+// version once per buffer and never reads the working copy. A sequence counter, odd while a
+// publish is in progress, tells the reader to retry instead of using a torn copy. There is a
+// single writer per parameter node, as the sound engine serializes calls on it.
+
+static const int PARAMS_SNAPSHOT_MAX_ATTEMPTS = 4;   // Execute keeps the previous buffer's copy past this
+static const int PARAMS_SNAPSHOT_INIT_ROUNDS = 16;   // Init falls back to ReadSnapshotUnchecked past this many ReadSnapshot calls
+
+/// Everything the sound engine plug-in reads from the parameter node while running.
+struct FlexibleDelayLinesParamsSnapshot
+{
+    FlexibleDelayLinesRTPCParams RTPC;
+    FlexibleDelayLinesNonRTPCParams NonRTPC;
+    FlexibleDelayLinesDelayCurve DelayCurve;
+    AkUInt32 uDelayCurveVersion;
+    AK::AkFXParameterChangeHandler<NUM_PARAMS> changes;   // Since the version the reader last took
 };
 
 struct FlexibleDelayLinesFXParams : public AK::IAkPluginParam
@@ -79,10 +201,42 @@ struct FlexibleDelayLinesFXParams : public AK::IAkPluginParam
     /// Update a single parameter at a time and perform the necessary actions on the parameter changes.
     AKRESULT SetParam(AkPluginParamID in_paramID, const void* in_pValue, AkUInt32 in_ulParamSize) override;
 
+    /// Validates and stores a delay curve blob (see FlexibleDelayLinesDelayCurve).
+    AKRESULT SetDelayCurve(const void* in_pValue, AkUInt32 in_ulParamSize);
+
+    /// Reads the baked filter tables from the end of a bank block. Returns false, leaving
+    /// FilterTables unspecified, when the tail is missing, unknown or inconsistent.
+    bool ReadFilterTables(AkUInt8* in_pTail, AkUInt32 in_ulTailSize);
+
+    /// Copies the latest published version into out_snapshot unless io_uSequence already names it.
+    /// Returns false, leaving out_snapshot as it was, when there is nothing new or a publish
+    /// stayed in progress for in_maxAttempts reads. Never blocks.
+    bool ReadSnapshot(FlexibleDelayLinesParamsSnapshot& out_snapshot, AkUInt32& io_uSequence, int in_maxAttempts);
+
+    /// Copies the published version without waiting for a publish in progress to finish. The copy
+    /// may be torn, so io_uSequence is left odd: the next ReadSnapshot always replaces it.
+    void ReadSnapshotUnchecked(FlexibleDelayLinesParamsSnapshot& out_snapshot, AkUInt32& io_uSequence);
+
+    /// Writer side: clears the change flags the reader has already taken.
+    void BeginChange();
+    /// Writer side: publishes the working copy and the changes since the reader's version.
+    void Publish();
+
     AK::AkFXParameterChangeHandler<NUM_PARAMS> m_paramChangeHandler;
 
     FlexibleDelayLinesRTPCParams RTPC;
     FlexibleDelayLinesNonRTPCParams NonRTPC;
+    
+    FlexibleDelayLinesDelayCurve DelayCurve;
+    AkUInt32 uDelayCurveVersion;   // Bumped on every accepted curve
+
+    FlexibleDelayLinesFilterTables FilterTables;
+    bool bHasFilterTables;         // FilterTables came with the bank block
+
+private:
+    FlexibleDelayLinesParamsSnapshot m_published;
+    AkAtomic32 m_uSequence;          // Twice the number of publishes, plus one while publishing
+    AkAtomic32 m_uConsumedSequence;  // Last version ReadSnapshot handed out
 };
 
 #endif // FlexibleDelayLinesFXParams_H
@@ -0,0 +1,125 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+#include "FlexibleDelayLinesFXProfiler.h"
+
+#include <AK/Tools/Common/AkPlatformFuncs.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+FlexibleDelayLinesFXProfiler::FlexibleDelayLinesFXProfiler()
+    : m_uNumCalls(0)
+    , m_fMaxLoad(0.0f)
+    , m_fMaxMicroseconds(0.0f)
+    , m_fTicksPerMicrosecond(1.0f)
+    , m_startTicks(0)
+{
+    AkInt64 frequency;
+    AKPLATFORM::PerformanceFrequency(&frequency);
+    m_fTicksPerMicrosecond = (float)((double)frequency * 0.000001);
+    Clear();
+}
+
+void FlexibleDelayLinesFXProfiler::Begin()
+{
+    AKPLATFORM::PerformanceCounter(&m_startTicks);
+}
+
+void FlexibleDelayLinesFXProfiler::End(AkUInt32 in_uFrames, float in_fSampleRate)
+{
+    AkInt64 endTicks;
+    AKPLATFORM::PerformanceCounter(&endTicks);
+    
+    if (in_uFrames == 0)
+        return;
+    
+    float microseconds = (float)(endTicks - m_startTicks) / m_fTicksPerMicrosecond;
+    float deadline = (float)in_uFrames * 1000000.0f / in_fSampleRate;
+    float load = microseconds / deadline;
+    
+    int bin = load > MIN_LOAD ? (int)(log2f(load / MIN_LOAD) * (float)BINS_PER_OCTAVE) : 0;
+    ++m_bins[bin < NUM_BINS ? bin : NUM_BINS - 1];
+    ++m_uNumCalls;
+    
+    if (load > m_fMaxLoad)
+        m_fMaxLoad = load;
+    if (microseconds > m_fMaxMicroseconds)
+        m_fMaxMicroseconds = microseconds;
+}
+
+void FlexibleDelayLinesFXProfiler::Clear()
+{
+    memset(m_bins, 0, sizeof(m_bins));
+    m_uNumCalls = 0;
+    m_fMaxLoad = 0.0f;
+    m_fMaxMicroseconds = 0.0f;
+}
+
+float FlexibleDelayLinesFXProfiler::GetLoadPercentile(float in_fPercentile) const
+{
+    AkUInt64 rank = (AkUInt64)ceil((double)in_fPercentile * (double)m_uNumCalls);
+    if (rank == 0)
+        rank = 1;
+    
+    AkUInt64 count = 0;
+    for (int bin = 0; bin < NUM_BINS; ++bin)
+    {
+        count += m_bins[bin];
+        if (count >= rank)
+        {
+            // Upper edge of the bin, never above what was actually measured
+            float load = MIN_LOAD * exp2f((float)(bin + 1) / (float)BINS_PER_OCTAVE);
+            return load < m_fMaxLoad ? load : m_fMaxLoad;
+        }
+    }
+    return m_fMaxLoad;
+}
+
+void FlexibleDelayLinesFXProfiler::Report(AK::IAkPluginContextBase* in_pContext, const char* in_pszConfiguration) const
+{
+    if (in_pContext == nullptr || m_uNumCalls == 0)
+        return;
+    
+    const float p999 = GetLoadPercentile(0.999f);
+    const bool bPass = p999 <= FLEXIBLEDELAYLINES_PROFILE_BUDGET;
+    
+    char message[256];
+    snprintf(message, sizeof(message),
+        "FlexibleDelayLines [%s] %llu calls, load p50 %.2f%% p99 %.2f%% p999 %.2f%% max %.2f%% (%.0f us), budget %.2f%%: %s",
+        in_pszConfiguration,
+        (unsigned long long)m_uNumCalls,
+        GetLoadPercentile(0.5f) * 100.0f,
+        GetLoadPercentile(0.99f) * 100.0f,
+        p999 * 100.0f,
+        m_fMaxLoad * 100.0f,
+        m_fMaxMicroseconds,
+        FLEXIBLEDELAYLINES_PROFILE_BUDGET * 100.0f,
+        bPass ? "PASS" : "FAIL");
+    
+    in_pContext->PostMonitorMessage(message, bPass ? AK::Monitor::ErrorLevel_Message : AK::Monitor::ErrorLevel_Error);
+}
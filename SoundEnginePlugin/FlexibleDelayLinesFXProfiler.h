@@ -0,0 +1,79 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef FlexibleDelayLinesFXProfiler_H
+#define FlexibleDelayLinesFXProfiler_H
+
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+// Pass mark of the profiler report: share of the buffer period the slowest 0.1% of Execute calls may take.
+// One instance out of several dozen on the same audio frame.
+#ifndef FLEXIBLEDELAYLINES_PROFILE_BUDGET
+#define FLEXIBLEDELAYLINES_PROFILE_BUDGET 0.02f
+#endif
+
+/// Execute latency histogram for soak and stress sessions, built in with FLEXIBLEDELAYLINES_PROFILE_EXECUTE.
+/// Each call is timed against its own deadline (the duration of the buffer it processes) and binned
+/// on a logarithmic scale, so the tail percentiles need no sorting and no memory beyond the bins.
+/// Averages hide the buffers that miss the deadline: the report gives p50, p99, p999 and max.
+class FlexibleDelayLinesFXProfiler
+{
+public:
+    FlexibleDelayLinesFXProfiler();
+
+    /// Starts timing one call.
+    void Begin();
+
+    /// Stops timing and bins the call against the duration of in_uFrames at in_fSampleRate.
+    void End(AkUInt32 in_uFrames, float in_fSampleRate);
+
+    void Clear();
+
+    AkUInt64 GetNumCalls() const { return m_uNumCalls; }
+
+    /// Share of the deadline within which in_fPercentile of the calls completed, rounded up to the bin edge.
+    float GetLoadPercentile(float in_fPercentile) const;
+    float GetMaxLoad() const { return m_fMaxLoad; }
+
+    /// Posts the percentiles to the Wwise profiler, as an error when the p999 is over FLEXIBLEDELAYLINES_PROFILE_BUDGET.
+    /// in_pszConfiguration names the settings that were measured.
+    void Report(AK::IAkPluginContextBase* in_pContext, const char* in_pszConfiguration) const;
+
+private:
+    static constexpr int BINS_PER_OCTAVE = 8;   // About 9% wide
+    static constexpr int NUM_OCTAVES = 20;      // 2^-16 to 16 times the deadline
+    static constexpr int NUM_BINS = BINS_PER_OCTAVE * NUM_OCTAVES;
+    static constexpr float MIN_LOAD = 1.0f / 65536.0f;
+
+    AkUInt32 m_bins[NUM_BINS];
+    AkUInt64 m_uNumCalls;
+    float m_fMaxLoad;
+    float m_fMaxMicroseconds;
+    float m_fTicksPerMicrosecond;
+    AkInt64 m_startTicks;
+};
+
+#endif // FlexibleDelayLinesFXProfiler_H
@@ -0,0 +1,316 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+#ifndef FlexibleDelayLinesFXStorage_H
+#define FlexibleDelayLinesFXStorage_H
+
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+#include <string.h>
+
+// SSE2 is part of every x64 target; other targets keep the scalar codecs and FDN mixing
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLEXIBLEDELAYLINES_SSE2
+#endif
+
+enum DelayStorageFormat
+{
+    STORAGE_FLOAT32 = 0,
+    STORAGE_HALF = 1,
+    STORAGE_INT16 = 2,
+    STORAGE_PACKED24 = 3
+};
+
+// Integer formats keep +12 dB of headroom above full scale for feedback build-up
+static constexpr float DELAY_STORAGE_HEADROOM = 4.0f;
+
+// ==================== STORAGE CODECS ====================
+// Each codec converts one sample on write and on read, so the delay kernels
+// can be instantiated once per format and keep a single inner loop.
+// StoreBlock writes a run of sequential samples four at a time when SSE2 is
+// available, rounding exactly as Store does; BATCHED_STORE tells the kernels
+// whether holding writes back for it pays off.
+
+// Full precision IEEE float (4 bytes per sample)
+struct DelayStorageFloat32
+{
+    static constexpr int BYTES_PER_SAMPLE = 4;
+    static constexpr bool BATCHED_STORE = false;   // Store is a plain store already
+    
+    static inline float Load(const AkUInt8* in_pBuffer, int in_index)
+    {
+        return ((const float*)in_pBuffer)[in_index];
+    }
+    
+    static inline void Store(AkUInt8* in_pBuffer, int in_index, float in_value)
+    {
+        ((float*)in_pBuffer)[in_index] = in_value;
+    }
+    
+    static inline void StoreBlock(AkUInt8* in_pBuffer, int in_index, const float* in_pValues, int in_count)
+    {
+        memcpy((float*)in_pBuffer + in_index, in_pValues, sizeof(float) * (size_t)in_count);
+    }
+};
+
+// IEEE half float (2 bytes per sample), round to nearest even
+struct DelayStorageHalf
+{
+    static constexpr int BYTES_PER_SAMPLE = 2;
+    static constexpr bool BATCHED_STORE = true;
+    
+    static inline float Load(const AkUInt8* in_pBuffer, int in_index)
+    {
+        AkUInt16 half = ((const AkUInt16*)in_pBuffer)[in_index];
+        
+        AkUInt32 bits = (AkUInt32)(half & 0x7FFF) << 13;
+        AkUInt32 exponent = bits & (0x7C00 << 13);
+        bits += (127 - 15) << 23;
+        
+        float value;
+        if (exponent == (0x7C00 << 13))
+        {
+            // Inf/NaN
+            bits += (128 - 16) << 23;
+            memcpy(&value, &bits, sizeof(float));
+        }
+        else if (exponent == 0)
+        {
+            // Zero/Denormal
+            bits += 1 << 23;
+            memcpy(&value, &bits, sizeof(float));
+            value -= 6.103515625e-05f; // 2^-14
+        }
+        else
+        {
+            memcpy(&value, &bits, sizeof(float));
+        }
+        
+        return (half & 0x8000) ? -value : value;
+    }
+    
+    static inline void Store(AkUInt8* in_pBuffer, int in_index, float in_value)
+    {
+        AkUInt32 bits;
+        memcpy(&bits, &in_value, sizeof(float));
+        
+        AkUInt32 sign = (bits >> 16) & 0x8000;
+        bits &= 0x7FFFFFFF;
+        
+        AkUInt32 half;
+        if (bits >= ((127 + 16) << 23))
+        {
+            // Overflow to Inf, keep NaN quiet
+            half = (bits > (255u << 23)) ? 0x7E00 : 0x7C00;
+        }
+        else if (bits < (113 << 23))
+        {
+            // Denormal/zero: let the FPU round the mantissa into place
+            float magnitude;
+            memcpy(&magnitude, &bits, sizeof(float));
+            magnitude += 0.5f;
+            memcpy(&bits, &magnitude, sizeof(float));
+            half = bits - (126 << 23);
+        }
+        else
+        {
+            AkUInt32 mantissaOdd = (bits >> 13) & 1;
+            bits += ((AkUInt32)(15 - 127) << 23) + 0xFFF;
+            bits += mantissaOdd;
+            half = bits >> 13;
+        }
+        
+        ((AkUInt16*)in_pBuffer)[in_index] = (AkUInt16)(half | sign);
+    }
+    
+    static inline void StoreBlock(AkUInt8* in_pBuffer, int in_index, const float* in_pValues, int in_count)
+    {
+        int i = 0;
+#ifdef FLEXIBLEDELAYLINES_SSE2
+        // The three cases of Store, computed for every lane and selected with masks
+        const __m128i absMask = _mm_set1_epi32(0x7FFFFFFF);
+        const __m128i overflowMin = _mm_set1_epi32((127 + 16) << 23);
+        const __m128i normalMin = _mm_set1_epi32(113 << 23);
+        const __m128i infBits = _mm_set1_epi32(255 << 23);
+        const __m128i rebias = _mm_set1_epi32((AkInt32)((AkUInt32)(15 - 127) << 23) + 0xFFF);
+        const __m128i denormalBias = _mm_set1_epi32(126 << 23);
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128 half = _mm_set1_ps(0.5f);
+        AkUInt16* pOut = (AkUInt16*)in_pBuffer + in_index;
+        
+        for (; i + 4 <= in_count; i += 4)
+        {
+            const __m128i input = _mm_castps_si128(_mm_loadu_ps(in_pValues + i));
+            const __m128i sign = _mm_and_si128(_mm_srli_epi32(input, 16), _mm_set1_epi32(0x8000));
+            const __m128i bits = _mm_and_si128(input, absMask);
+            
+            const __m128i overflow = _mm_or_si128(_mm_cmpgt_epi32(bits, overflowMin), _mm_cmpeq_epi32(bits, overflowMin));
+            const __m128i nan = _mm_cmpgt_epi32(bits, infBits);
+            const __m128i infinity = _mm_or_si128(_mm_and_si128(nan, _mm_set1_epi32(0x7E00)), _mm_andnot_si128(nan, _mm_set1_epi32(0x7C00)));
+            
+            const __m128i denormal = _mm_cmplt_epi32(bits, normalMin);
+            const __m128i denormalHalf = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), half)), denormalBias);
+            
+            const __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(bits, 13), one);
+            const __m128i normalHalf = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(bits, rebias), mantissaOdd), 13);
+            
+            __m128i result = _mm_or_si128(_mm_and_si128(denormal, denormalHalf), _mm_andnot_si128(denormal, normalHalf));
+            result = _mm_or_si128(_mm_and_si128(overflow, infinity), _mm_andnot_si128(overflow, result));
+            result = _mm_or_si128(result, sign);
+            
+            // Sign-extend the low 16 bits so the saturating pack keeps them as they are
+            result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+            _mm_storel_epi64((__m128i*)(pOut + i), _mm_packs_epi32(result, result));
+        }
+#endif
+        for (; i < in_count; ++i)
+            Store(in_pBuffer, in_index + i, in_pValues[i]);
+    }
+};
+
+// Scaled 16-bit integer (2 bytes per sample)
+struct DelayStorageInt16
+{
+    static constexpr int BYTES_PER_SAMPLE = 2;
+    static constexpr bool BATCHED_STORE = true;
+    static constexpr float SCALE = 32767.0f / DELAY_STORAGE_HEADROOM;
+    static constexpr float INV_SCALE = DELAY_STORAGE_HEADROOM / 32767.0f;
+    
+    static inline float Load(const AkUInt8* in_pBuffer, int in_index)
+    {
+        return (float)((const AkInt16*)in_pBuffer)[in_index] * INV_SCALE;
+    }
+    
+    static inline void Store(AkUInt8* in_pBuffer, int in_index, float in_value)
+    {
+        float scaled = in_value * SCALE;
+        scaled = scaled > 32767.0f ? 32767.0f : (scaled < -32767.0f ? -32767.0f : scaled);
+        ((AkInt16*)in_pBuffer)[in_index] = (AkInt16)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+    }
+    
+    static inline void StoreBlock(AkUInt8* in_pBuffer, int in_index, const float* in_pValues, int in_count)
+    {
+        int i = 0;
+#ifdef FLEXIBLEDELAYLINES_SSE2
+        AkInt16* pOut = (AkInt16*)in_pBuffer + in_index;
+        for (; i + 4 <= in_count; i += 4)
+        {
+            const __m128i value = RoundScaled(_mm_loadu_ps(in_pValues + i), SCALE, 32767.0f);
+            _mm_storel_epi64((__m128i*)(pOut + i), _mm_packs_epi32(value, value));
+        }
+#endif
+        for (; i < in_count; ++i)
+            Store(in_pBuffer, in_index + i, in_pValues[i]);
+    }
+    
+#ifdef FLEXIBLEDELAYLINES_SSE2
+    // Scale, clamp and round half away from zero, as Store does
+    static inline __m128i RoundScaled(__m128 in_values, float in_scale, float in_limit)
+    {
+        __m128 scaled = _mm_mul_ps(in_values, _mm_set1_ps(in_scale));
+        scaled = _mm_min_ps(_mm_max_ps(scaled, _mm_set1_ps(-in_limit)), _mm_set1_ps(in_limit));
+        
+        // -0.5 below zero only: Store rounds -0 with +0.5, which truncates to the same 0
+        const __m128 negative = _mm_cmplt_ps(scaled, _mm_setzero_ps());
+        const __m128 rounding = _mm_or_ps(_mm_and_ps(negative, _mm_set1_ps(-0.5f)), _mm_andnot_ps(negative, _mm_set1_ps(0.5f)));
+        return _mm_cvttps_epi32(_mm_add_ps(scaled, rounding));
+    }
+#endif
+};
+
+// Scaled 24-bit integer packed little-endian (3 bytes per sample)
+struct DelayStoragePacked24
+{
+    static constexpr int BYTES_PER_SAMPLE = 3;
+    static constexpr bool BATCHED_STORE = true;
+    static constexpr float SCALE = 8388607.0f / DELAY_STORAGE_HEADROOM;
+    static constexpr float INV_SCALE = DELAY_STORAGE_HEADROOM / 8388607.0f;
+    
+    static inline float Load(const AkUInt8* in_pBuffer, int in_index)
+    {
+        const AkUInt8* pSample = in_pBuffer + in_index * BYTES_PER_SAMPLE;
+        
+        // Assemble in the top 24 bits, then sign-extend with an arithmetic shift
+        AkInt32 value = (AkInt32)(((AkUInt32)pSample[0] << 8)
+                                | ((AkUInt32)pSample[1] << 16)
+                                | ((AkUInt32)pSample[2] << 24)) >> 8;
+        
+        return (float)value * INV_SCALE;
+    }
+    
+    static inline void Store(AkUInt8* in_pBuffer, int in_index, float in_value)
+    {
+        float scaled = in_value * SCALE;
+        scaled = scaled > 8388607.0f ? 8388607.0f : (scaled < -8388607.0f ? -8388607.0f : scaled);
+        AkInt32 value = (AkInt32)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+        
+        AkUInt8* pSample = in_pBuffer + in_index * BYTES_PER_SAMPLE;
+        pSample[0] = (AkUInt8)(value);
+        pSample[1] = (AkUInt8)(value >> 8);
+        pSample[2] = (AkUInt8)(value >> 16);
+    }
+    
+    static inline void StoreBlock(AkUInt8* in_pBuffer, int in_index, const float* in_pValues, int in_count)
+    {
+        int i = 0;
+#ifdef FLEXIBLEDELAYLINES_SSE2
+        for (; i + 4 <= in_count; i += 4)
+        {
+            AkInt32 values[4];
+            _mm_storeu_si128((__m128i*)values, DelayStorageInt16::RoundScaled(_mm_loadu_ps(in_pValues + i), SCALE, 8388607.0f));
+            
+            // Four samples fill three little-endian words exactly
+            const AkUInt32 words[3] = {
+                ((AkUInt32)values[0] & 0xFFFFFF) | ((AkUInt32)values[1] << 24),
+                (((AkUInt32)values[1] >> 8) & 0xFFFF) | ((AkUInt32)values[2] << 16),
+                (((AkUInt32)values[2] >> 16) & 0xFF) | ((AkUInt32)values[3] << 8)
+            };
+            memcpy(in_pBuffer + (in_index + i) * BYTES_PER_SAMPLE, words, sizeof(words));
+        }
+#endif
+        for (; i < in_count; ++i)
+            Store(in_pBuffer, in_index + i, in_pValues[i]);
+    }
+};
+
+inline int GetDelayStorageBytesPerSample(AkUInt32 in_format)
+{
+    switch (in_format)
+    {
+    case STORAGE_HALF:
+        return DelayStorageHalf::BYTES_PER_SAMPLE;
+    case STORAGE_INT16:
+        return DelayStorageInt16::BYTES_PER_SAMPLE;
+    case STORAGE_PACKED24:
+        return DelayStoragePacked24::BYTES_PER_SAMPLE;
+    case STORAGE_FLOAT32:
+    default:
+        return DelayStorageFloat32::BYTES_PER_SAMPLE;
+    }
+}
+
+#endif // FlexibleDelayLinesFXStorage_H
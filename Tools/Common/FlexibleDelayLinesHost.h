@@ -0,0 +1,302 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+// Hosts FlexibleDelayLinesFX without the sound engine, for the tools next to the plug-in:
+// the offline renderer, the stress harness and the measurement suite. Each tool is a single
+// translation unit built with the sound engine sources, so this header defines everything.
+
+#ifndef FlexibleDelayLinesHost_H
+#define FlexibleDelayLinesHost_H
+
+#include "../../SoundEnginePlugin/FlexibleDelayLinesFX.h"
+#include "../../SoundEnginePlugin/FlexibleDelayLinesFXParams.h"
+
+#include <atomic>
+#include <chrono>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+AK::IAkPlugin* CreateFlexibleDelayLinesFX(AK::IAkPluginMemAlloc* in_pAllocator);
+AK::IAkPluginParam* CreateFlexibleDelayLinesFXParams(AK::IAkPluginMemAlloc* in_pAllocator);
+
+// ==================== HOST ALLOCATOR ====================
+
+// Every block carries a header so Free and Realloc work the same on aligned blocks.
+// The C runtime heap is thread-safe, which the shared delay memory pool relies on.
+class RenderAllocator : public AK::IAkPluginMemAlloc
+{
+public:
+    RenderAllocator() : m_uLiveBytes(0), m_uPeakBytes(0) {}
+
+    void* Malloc(size_t in_uSize, const char*, AkUInt32) override
+    {
+        return Allocate(in_uSize, sizeof(void*) * 2);
+    }
+
+    void Free(void* in_pMemAddress) override
+    {
+        if (in_pMemAddress != nullptr)
+        {
+            m_uLiveBytes -= GetHeader(in_pMemAddress)->uSize;
+            free(GetHeader(in_pMemAddress)->pBase);
+        }
+    }
+
+    void* Malign(size_t in_uSize, size_t in_uAlignment, const char*, AkUInt32) override
+    {
+        return Allocate(in_uSize, in_uAlignment);
+    }
+
+    void* Realloc(void* in_pMemAddress, size_t in_uSize, const char*, AkUInt32) override
+    {
+        return Reallocate(in_pMemAddress, in_uSize, sizeof(void*) * 2);
+    }
+
+    void* ReallocAligned(void* in_pMemAddress, size_t in_uSize, size_t in_uAlignment, const char*, AkUInt32) override
+    {
+        return Reallocate(in_pMemAddress, in_uSize, in_uAlignment);
+    }
+
+    // Bytes handed out and not freed yet, and the most there has been since ResetPeak
+    size_t GetLiveBytes() const { return m_uLiveBytes; }
+    size_t GetPeakBytes() const { return m_uPeakBytes; }
+    void ResetPeak() { m_uPeakBytes = m_uLiveBytes.load(); }
+
+private:
+    struct BlockHeader
+    {
+        void* pBase;
+        size_t uSize;
+    };
+
+    static BlockHeader* GetHeader(void* in_pBlock)
+    {
+        return (BlockHeader*)in_pBlock - 1;
+    }
+
+    void* Allocate(size_t in_uSize, size_t in_uAlignment)
+    {
+        if (in_uAlignment < sizeof(BlockHeader))
+            in_uAlignment = sizeof(BlockHeader);
+
+        AkUInt8* pBase = (AkUInt8*)malloc(in_uSize + in_uAlignment + sizeof(BlockHeader));
+        if (pBase == nullptr)
+            return nullptr;
+
+        uintptr_t block = ((uintptr_t)pBase + sizeof(BlockHeader) + in_uAlignment - 1) & ~(uintptr_t)(in_uAlignment - 1);
+        GetHeader((void*)block)->pBase = pBase;
+        GetHeader((void*)block)->uSize = in_uSize;
+
+        const size_t uLiveBytes = m_uLiveBytes += in_uSize;
+        size_t uPeakBytes = m_uPeakBytes;
+        while (uLiveBytes > uPeakBytes && !m_uPeakBytes.compare_exchange_weak(uPeakBytes, uLiveBytes))
+        {
+        }
+        return (void*)block;
+    }
+
+    void* Reallocate(void* in_pMemAddress, size_t in_uSize, size_t in_uAlignment)
+    {
+        void* pBlock = Allocate(in_uSize, in_uAlignment);
+        if (pBlock != nullptr && in_pMemAddress != nullptr)
+        {
+            size_t uOldSize = GetHeader(in_pMemAddress)->uSize;
+            memcpy(pBlock, in_pMemAddress, uOldSize < in_uSize ? uOldSize : in_uSize);
+            Free(in_pMemAddress);
+        }
+        return pBlock;
+    }
+
+    std::atomic<size_t> m_uLiveBytes;
+    std::atomic<size_t> m_uPeakBytes;
+};
+
+// ==================== PARAMETERS ====================
+// Names are the property names of FlexibleDelayLines.xml, without the distance source and
+// listener settings: there is no listener outside the sound engine.
+
+struct ParameterInfo
+{
+    const char* pszName;
+    AkPluginParamID id;
+    bool bRTPC;
+    float fMin;    // RTPC range of FlexibleDelayLines.xml; the enumerations are validated by the effect
+    float fMax;
+};
+
+static const ParameterInfo s_parameters[] =
+{
+    { "DelayTime", PARAM_DELAYTIME_ID, true, 0.001f, 43.0f },
+    { "WetDryMix", PARAM_WETDRYMIX_ID, true, 0.0f, 1.0f },
+    { "Feedback", PARAM_FEEDBACK_ID, true, 0.0f, 0.95f },
+    { "Distance", PARAM_DISTANCE_ID, true, 0.0f, 450.0f },
+    { "DelaySpread", PARAM_DELAYSPREAD_ID, true, 0.0f, 1.0f },
+    { "DampingLowpass", PARAM_DAMPINGLOWPASS_ID, true, 20.0f, 20000.0f },
+    { "DampingHighpass", PARAM_DAMPINGHIGHPASS_ID, true, 0.0f, 2000.0f },
+    { "ReferenceDistance", PARAM_REFERENCEDISTANCE_ID, true, 0.1f, 100.0f },
+    { "JumpThreshold", PARAM_JUMPTHRESHOLD_ID, true, 0.0f, 10.0f },
+    { "CrossfadeTime", PARAM_CROSSFADETIME_ID, true, 1.0f, 500.0f },
+    { "InterpolationType", PARAM_INTERPOLATIONTYPE_ID, false, 0.0f, 0.0f },
+    { "OversamplingFactor", PARAM_OVERSAMPLINGFACTOR_ID, false, 0.0f, 0.0f },
+    { "UpsamplingMethod", PARAM_UPSAMPLINGMETHOD_ID, false, 0.0f, 0.0f },
+    { "StorageFormat", PARAM_STORAGEFORMAT_ID, false, 0.0f, 0.0f },
+    { "DelayMemoryMode", PARAM_DELAYMEMORYMODE_ID, false, 0.0f, 0.0f },
+    { "DecimationFactor", PARAM_DECIMATIONFACTOR_ID, false, 0.0f, 0.0f },
+    { "FilterPhase", PARAM_FILTERPHASE_ID, false, 0.0f, 0.0f },
+    { "FeedbackMatrix", PARAM_FEEDBACKMATRIX_ID, false, 0.0f, 0.0f },
+    { "DCBlocker", PARAM_DCBLOCKER_ID, false, 0.0f, 0.0f },
+    { "DistanceEffects", PARAM_DISTANCEEFFECTS_ID, false, 0.0f, 0.0f },
+    { "VirtualSnapshot", PARAM_VIRTUALSNAPSHOT_ID, false, 0.0f, 0.0f },
+    { "MaxDelayTime", PARAM_MAXDELAYTIME_ID, false, 0.0f, 0.0f },
+    { "BandSplitCrossover", PARAM_BANDSPLITCROSSOVER_ID, false, 0.0f, 0.0f },
+};
+
+static const int NUM_PARAMETER_INFOS = (int)(sizeof(s_parameters) / sizeof(s_parameters[0]));
+
+inline void SetParameter(FlexibleDelayLinesFXParams* io_pParams, const ParameterInfo& in_info, float in_value)
+{
+    if (in_info.bRTPC)
+    {
+        AkReal32 value = in_value;
+        io_pParams->SetParam(in_info.id, &value, sizeof(value));
+    }
+    else
+    {
+        AkUInt32 value = in_value > 0.0f ? (AkUInt32)(in_value + 0.5f) : 0;
+        io_pParams->SetParam(in_info.id, &value, sizeof(value));
+    }
+}
+
+// ==================== HOSTED INSTANCE ====================
+
+// One plug-in instance and its parameter node, processing planar buffers as a single audio
+// object the way the sound engine drives an effect on a bus or a voice. There is no plug-in
+// context: the effect already treats it as optional (no listeners, no monitoring), so the
+// distance always comes from the Distance parameter.
+class HostedEffect
+{
+public:
+    explicit HostedEffect(AK::IAkPluginMemAlloc* in_pAllocator)
+        : m_pAllocator(in_pAllocator)
+        , m_pParams(nullptr)
+        , m_pFX(nullptr)
+        , m_uNumChannels(0)
+    {
+        m_object.key = AK_INVALID_AUDIO_OBJECT_ID;
+        m_pBuffer = &m_buffer;
+        m_pObject = &m_object;
+        m_objects.uNumObjects = 1;
+        m_objects.ppObjectBuffers = &m_pBuffer;
+        m_objects.ppObjects = &m_pObject;
+    }
+
+    ~HostedEffect() { Term(); }
+
+    /// Creates the parameter node and the effect. Set the parameters between Create and Init:
+    /// the non-RTPC settings are read once, by Init.
+    bool Create()
+    {
+        m_pParams = (FlexibleDelayLinesFXParams*)CreateFlexibleDelayLinesFXParams(m_pAllocator);
+        m_pFX = static_cast<AK::IAkInPlaceObjectPlugin*>(CreateFlexibleDelayLinesFX(m_pAllocator));
+        if (m_pParams == nullptr || m_pFX == nullptr || m_pParams->Init(m_pAllocator, nullptr, 0) != AK_Success)
+        {
+            Term();
+            return false;
+        }
+
+        AkUInt32 distanceSource = DISTANCE_SOURCE_RTPC;
+        m_pParams->SetParam(PARAM_DISTANCESOURCE_ID, &distanceSource, sizeof(distanceSource));
+        return true;
+    }
+
+    bool Init(AkUInt32 in_uSampleRate, AkUInt32 in_uNumChannels)
+    {
+        m_channelConfig.SetAnonymous(in_uNumChannels);
+        m_uNumChannels = in_uNumChannels;
+
+        AkAudioFormat format;
+        format.uSampleRate = in_uSampleRate;
+        format.channelConfig = m_channelConfig;
+        return m_pFX->Init(m_pAllocator, nullptr, m_pParams, format) == AK_Success;
+    }
+
+    void Term()
+    {
+        if (m_pFX != nullptr)
+            m_pFX->Term(m_pAllocator);
+        if (m_pParams != nullptr)
+            m_pParams->Term(m_pAllocator);
+        m_pFX = nullptr;
+        m_pParams = nullptr;
+    }
+
+    FlexibleDelayLinesFXParams* GetParams() const { return m_pParams; }
+    AK::IAkInPlaceObjectPlugin* GetEffect() const { return m_pFX; }
+    AkUInt32 GetNumChannels() const { return m_uNumChannels; }
+
+    /// Processes in_uFrames of io_pPlanar in place, channels in_uBufferFrames apart, and
+    /// returns the time spent in Execute alone, in seconds.
+    double Execute(float* io_pPlanar, AkUInt32 in_uBufferFrames, AkUInt32 in_uFrames, bool in_bLastBuffer)
+    {
+        m_buffer.AttachContiguousDeinterleavedData(io_pPlanar, (AkUInt16)in_uBufferFrames, (AkUInt16)in_uFrames, m_channelConfig);
+        m_buffer.eState = in_bLastBuffer ? AK_NoMoreData : AK_DataReady;
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        m_pFX->Execute(m_objects);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /// What the sound engine calls instead of Execute while the voice is virtual.
+    void TimeSkip(AkUInt32 in_uFrames)
+    {
+        m_pFX->TimeSkip(m_objects, in_uFrames);
+    }
+
+    void Reset()
+    {
+        m_pFX->Reset();
+    }
+
+private:
+    HostedEffect(const HostedEffect&) = delete;
+    HostedEffect& operator=(const HostedEffect&) = delete;
+
+    AK::IAkPluginMemAlloc* m_pAllocator;
+    FlexibleDelayLinesFXParams* m_pParams;
+    AK::IAkInPlaceObjectPlugin* m_pFX;
+    AkChannelConfig m_channelConfig;
+    AkUInt32 m_uNumChannels;
+
+    AkAudioBuffer m_buffer;
+    AkAudioObject m_object;
+    AkAudioBuffer* m_pBuffer;
+    AkAudioObject* m_pObject;
+    AkAudioObjects m_objects;
+};
+
+#endif // FlexibleDelayLinesHost_H
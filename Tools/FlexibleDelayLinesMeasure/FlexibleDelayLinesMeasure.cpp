@@ -0,0 +1,546 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+// Measurement suite behind the interpolation and oversampling tiers of the README. Each
+// configuration is rendered mono at 48 kHz in 512-frame buffers, wet only, without feedback,
+// from contiguous Float32 storage, over sines through a fixed delay (stepped sweep) and delays
+// moving at constant rates (THD+N, Doppler SNR, pitch error, image rejection, aliasing). The
+// quality figures are joined with the Execute time and peak memory of the same instance, and
+// printed as the Markdown table the README carries.
+
+#include "../Common/FlexibleDelayLinesHost.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Normally defined by the sound engine, which the suite does not link
+AK::PluginRegistration* g_pAKPluginList = nullptr;
+
+static const AkUInt32 SAMPLE_RATE = 48000;
+static const AkUInt32 BUFFER_FRAMES = 512;
+static const double TWO_PI = 6.283185307179586;
+static const float AMPLITUDE = 0.5f;
+static const double BASE_DELAY = 0.1 + 0.37 / SAMPLE_RATE;   // Between two samples, so the interpolator works
+static const double SETTLE_SECONDS = 0.5;                    // Skipped before analyzing: the delay and the filters fill up
+static const double WINDOW_SECONDS = 0.25;
+static const int DEFAULT_CPU_RUNS = 5;
+static const double CPU_SECONDS = 4.0;
+
+static RenderAllocator s_allocator;
+
+// ==================== CONFIGURATIONS ====================
+
+struct MeasureConfiguration
+{
+    const char* pszTier;           // nullptr outside the tier table
+    AkUInt32 interpolationType;
+    AkUInt32 oversamplingFactor;
+    AkUInt32 upsamplingMethod;
+    AkUInt32 bandSplitCrossover;   // Hz, 0 for the full band
+};
+
+// The README rows. The oversampled tiers read the ring with Linear; Hybrid measures the same there.
+static const MeasureConfiguration s_tiers[] =
+{
+    { "Cheapest", INTERP_LINEAR, OVERSAMPLE_NONE, UPSAMPLE_LINEAR, 0 },
+    { "Default", INTERP_POLYNOMIAL_4POINT, OVERSAMPLE_NONE, UPSAMPLE_LINEAR, 0 },
+    { "Doppler", INTERP_RESAMPLER, OVERSAMPLE_NONE, UPSAMPLE_LINEAR, 0 },
+    { "High", INTERP_LINEAR, OVERSAMPLE_2X, UPSAMPLE_IIR_HALFBAND, 0 },
+    { "Higher", INTERP_LINEAR, OVERSAMPLE_4X, UPSAMPLE_IIR_HALFBAND, 0 },
+    { "Very high", INTERP_LINEAR, OVERSAMPLE_8X, UPSAMPLE_IIR_HALFBAND, 0 },
+    { "Maximum", INTERP_LINEAR, OVERSAMPLE_16X, UPSAMPLE_IIR_HALFBAND, 0 },
+};
+
+static const char* const s_interpolationNames[] = { "Linear", "Power Complementary", "Polynomial 4-Point", "Hybrid", "Resampler" };
+static const char* const s_upsamplingNames[] = { "Linear", "Simple Sinc", "Polyphase", "IIR Half-band" };
+
+// Delay rates of the Doppler test, in seconds per second: about 5 to 17 m/s both ways
+static const double s_dopplerRates[] = { 0.0137, 0.0371, 0.05, -0.0293, -0.043 };
+static const double DOPPLER_FREQUENCY = 8000.0;
+
+// The images around k times the ring's rate fold next to the tone at k fs rate; 16 covers the 16x ring
+static const int MAX_IMAGE_ORDER = 16;
+static const double MIN_IMAGE_SPACING = 20.0;   // Hz, closer images are the tone itself
+
+// Aliasing: a 20 kHz sine raised by a source closing in at 30% of the speed of sound lands at
+// 26 kHz, which folds back to 22 kHz unless the read is band-limited to the Doppler factor
+static const double ALIAS_FREQUENCY = 20000.0;
+static const double ALIAS_RATE = -0.3;
+static const double ALIAS_START_DELAY = 1.0;
+
+// ==================== SIGNAL ====================
+
+struct Render
+{
+    std::vector<float> output;
+    double executeSeconds;
+    size_t uPeakBytes;
+};
+
+// A sine of in_fFrequency through a delay of BASE_DELAY (or in_fStartDelay) plus in_fRate seconds per
+// second. The delay is set once per buffer to its value at the end of the buffer, as an RTPC would
+// be, and the effect ramps to it linearly: the trajectory is exact.
+static bool RenderSine(const MeasureConfiguration& in_configuration, double in_fFrequency,
+    double in_fRate, double in_fStartDelay, double in_fSeconds, Render& out_render)
+{
+    const size_t uBaseBytes = s_allocator.GetLiveBytes();
+    s_allocator.ResetPeak();
+
+    HostedEffect effect(&s_allocator);
+    if (!effect.Create())
+        return false;
+
+    FlexibleDelayLinesFXParams* pParams = effect.GetParams();
+    const struct { AkPluginParamID id; AkReal32 value; } rtpcs[] = {
+        { PARAM_DISTANCE_ID, 0.0f },
+        { PARAM_FEEDBACK_ID, 0.0f },
+        { PARAM_WETDRYMIX_ID, 1.0f },
+        { PARAM_DAMPINGLOWPASS_ID, 20000.0f },
+        { PARAM_DAMPINGHIGHPASS_ID, 0.0f },
+        { PARAM_DELAYTIME_ID, (AkReal32)in_fStartDelay },
+    };
+    for (const auto& rtpc : rtpcs)
+        pParams->SetParam(rtpc.id, &rtpc.value, sizeof(rtpc.value));
+
+    const struct { AkPluginParamID id; AkUInt32 value; } settings[] = {
+        { PARAM_INTERPOLATIONTYPE_ID, in_configuration.interpolationType },
+        { PARAM_OVERSAMPLINGFACTOR_ID, in_configuration.oversamplingFactor },
+        { PARAM_UPSAMPLINGMETHOD_ID, in_configuration.upsamplingMethod },
+        { PARAM_STORAGEFORMAT_ID, STORAGE_FLOAT32 },
+        { PARAM_DELAYMEMORYMODE_ID, DELAY_MEMORY_CONTIGUOUS },
+        { PARAM_BANDSPLITCROSSOVER_ID, in_configuration.bandSplitCrossover },
+    };
+    for (const auto& setting : settings)
+        pParams->SetParam(setting.id, &setting.value, sizeof(setting.value));
+
+    if (!effect.Init(SAMPLE_RATE, 1))
+        return false;
+
+    const AkUInt32 uNumBuffers = ((AkUInt32)(in_fSeconds * SAMPLE_RATE) + BUFFER_FRAMES - 1) / BUFFER_FRAMES;
+    out_render.output.resize((size_t)uNumBuffers * BUFFER_FRAMES);
+    out_render.executeSeconds = 0.0;
+
+    const double phaseStep = TWO_PI * in_fFrequency / SAMPLE_RATE;
+    for (AkUInt32 buffer = 0; buffer < uNumBuffers; ++buffer)
+    {
+        const AkUInt32 start = buffer * BUFFER_FRAMES;
+        float* pBuffer = &out_render.output[start];
+        for (AkUInt32 frame = 0; frame < BUFFER_FRAMES; ++frame)
+            pBuffer[frame] = AMPLITUDE * (float)sin(phaseStep * (double)(start + frame));
+
+        if (in_fRate != 0.0)
+        {
+            AkReal32 delay = (AkReal32)(in_fStartDelay + in_fRate * (double)(start + BUFFER_FRAMES) / SAMPLE_RATE);
+            pParams->SetParam(PARAM_DELAYTIME_ID, &delay, sizeof(delay));
+        }
+
+        out_render.executeSeconds += effect.Execute(pBuffer, BUFFER_FRAMES, BUFFER_FRAMES, buffer + 1 == uNumBuffers);
+    }
+
+    out_render.uPeakBytes = s_allocator.GetPeakBytes() - uBaseBytes;
+    return true;
+}
+
+struct SineFit
+{
+    double amplitude;
+    double phase;
+    double residual;               // Power of what the sine and DC leave, relative to the sine's
+};
+
+// Least squares of a*sin + b*cos + c at in_fFrequency over in_numFrames from in_pSignal, whose first
+// frame is at in_start in the render. out_pResidual receives what the fit leaves, where weaker
+// components can be fitted without the leakage of the sine.
+static SineFit FitSine(const float* in_pSignal, int in_numFrames, AkUInt32 in_start, double in_fFrequency,
+    std::vector<float>* out_pResidual = nullptr)
+{
+    const double step = TWO_PI * in_fFrequency / SAMPLE_RATE;
+    double m[3][4] = {};
+    for (int i = 0; i < in_numFrames; ++i)
+    {
+        const double basis[3] = { sin(step * (double)(in_start + i)), cos(step * (double)(in_start + i)), 1.0 };
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 3; ++col)
+                m[row][col] += basis[row] * basis[col];
+            m[row][3] += basis[row] * (double)in_pSignal[i];
+        }
+    }
+
+    // Gauss-Jordan with partial pivoting
+    for (int pivot = 0; pivot < 3; ++pivot)
+    {
+        int best = pivot;
+        for (int row = pivot + 1; row < 3; ++row)
+        {
+            if (fabs(m[row][pivot]) > fabs(m[best][pivot]))
+                best = row;
+        }
+        for (int col = 0; col < 4; ++col)
+            std::swap(m[pivot][col], m[best][col]);
+        for (int row = 0; row < 3; ++row)
+        {
+            if (row == pivot)
+                continue;
+            const double factor = m[row][pivot] / m[pivot][pivot];
+            for (int col = 0; col < 4; ++col)
+                m[row][col] -= factor * m[pivot][col];
+        }
+    }
+    const double a = m[0][3] / m[0][0];
+    const double b = m[1][3] / m[1][1];
+    const double c = m[2][3] / m[2][2];
+
+    double residual = 0.0;
+    double signal = 0.0;
+    if (out_pResidual != nullptr)
+        out_pResidual->resize((size_t)in_numFrames);
+    for (int i = 0; i < in_numFrames; ++i)
+    {
+        const double sine = a * sin(step * (double)(in_start + i)) + b * cos(step * (double)(in_start + i));
+        const double error = (double)in_pSignal[i] - sine - c;
+        residual += error * error;
+        signal += sine * sine;
+        if (out_pResidual != nullptr)
+            (*out_pResidual)[i] = (float)error;
+    }
+
+    SineFit fit;
+    fit.amplitude = sqrt(a * a + b * b);
+    fit.phase = atan2(b, a);
+    fit.residual = residual / (signal + 1e-30);
+    return fit;
+}
+
+static double ToDecibels(double in_fRatio)
+{
+    return 20.0 * log10(in_fRatio > 1e-10 ? in_fRatio : 1e-10);
+}
+
+// Rounded to the printed tenth, without "-0.0"
+static double ToTenth(double in_fValue)
+{
+    const double rounded = floor(in_fValue * 10.0 + 0.5) / 10.0;
+    return rounded == 0.0 ? 0.0 : rounded;
+}
+
+// ==================== MEASUREMENTS ====================
+
+struct Measurements
+{
+    double dopplerSNR;             // dB, worst over s_dopplerRates
+    double pitchErrorCents;        // Largest deviation from the Doppler pitch
+    double imageRejection;         // dB below the tone of the strongest folded image
+    double aliasing;               // dB of the folded 26 kHz, relative to the input
+    double thdn;                   // dB, 1 kHz through the slowest Doppler rate
+    double gain10k;                // dB, 10 kHz through the fixed delay
+    double sweepDeviation;         // Largest |gain| in dB over the stepped sweep, 20 Hz to 16 kHz
+    double cpuPercent;             // Of one core, best of the CPU runs
+    size_t uPeakBytes;
+};
+
+static bool Measure(const MeasureConfiguration& in_configuration, int in_numCPURuns, Measurements& out_measurements)
+{
+    const AkUInt32 settle = (AkUInt32)(SETTLE_SECONDS * SAMPLE_RATE);
+    const int window = (int)(WINDOW_SECONDS * SAMPLE_RATE);
+    Render render;
+
+    // Stepped sweep, third octaves from 20 Hz; the 10 kHz step is reported on its own
+    out_measurements.sweepDeviation = 0.0;
+    out_measurements.gain10k = 0.0;
+    for (int step = 0; ; ++step)
+    {
+        const double frequency = 20.0 * pow(2.0, (double)step / 3.0);
+        if (frequency > 16000.0)
+            break;
+        if (!RenderSine(in_configuration, frequency, 0.0, BASE_DELAY, SETTLE_SECONDS + WINDOW_SECONDS * 4.0, render))
+            return false;
+        const double gain = ToDecibels(FitSine(&render.output[settle], window * 4, settle, frequency).amplitude / AMPLITUDE);
+        if (fabs(gain) > fabs(out_measurements.sweepDeviation))
+            out_measurements.sweepDeviation = gain;
+    }
+    if (!RenderSine(in_configuration, 10000.0, 0.0, BASE_DELAY, SETTLE_SECONDS + WINDOW_SECONDS, render))
+        return false;
+    out_measurements.gain10k = ToDecibels(FitSine(&render.output[settle], window, settle, 10000.0).amplitude / AMPLITUDE);
+
+    // A fixed delay is a linear filter: the distortion and noise only show once it moves
+    if (!RenderSine(in_configuration, 1000.0, s_dopplerRates[0], BASE_DELAY, SETTLE_SECONDS + WINDOW_SECONDS * 2.0, render))
+        return false;
+    const double thdnFrequency = 1000.0 * (1.0 - s_dopplerRates[0]);
+    out_measurements.thdn = 10.0 * log10(FitSine(&render.output[settle], window * 2, settle, thdnFrequency).residual + 1e-20);
+
+    // Doppler: the tone lands at f (1 - rate). The pitch comes from its phase advance between two
+    // windows; the images of the up-sampler and interpolator fold to f (1 - rate) + k fs rate.
+    out_measurements.dopplerSNR = 1e9;
+    out_measurements.pitchErrorCents = 0.0;
+    out_measurements.imageRejection = 1e9;
+    for (double rate : s_dopplerRates)
+    {
+        if (!RenderSine(in_configuration, DOPPLER_FREQUENCY, rate, BASE_DELAY, SETTLE_SECONDS + WINDOW_SECONDS * 3.0, render))
+            return false;
+
+        const double tone = DOPPLER_FREQUENCY * (1.0 - rate);
+        const AkUInt32 second = settle + (AkUInt32)window * 2;
+        std::vector<float> residual;
+        const SineFit first = FitSine(&render.output[settle], window, settle, tone, &residual);
+        const SineFit last = FitSine(&render.output[second], window, second, tone);
+        out_measurements.dopplerSNR = std::min(out_measurements.dopplerSNR, -10.0 * log10(first.residual + 1e-20));
+
+        // Both fits share the time origin of the render: the phases match unless the pitch is off
+        const double phaseError = remainder(last.phase - first.phase, TWO_PI);
+        const double frequencyError = phaseError * SAMPLE_RATE / (TWO_PI * (double)(second - settle));
+        const double cents = 1200.0 * log2((tone + frequencyError) / tone);
+        if (fabs(cents) > fabs(out_measurements.pitchErrorCents))
+            out_measurements.pitchErrorCents = cents;
+
+        for (int order = -MAX_IMAGE_ORDER; order <= MAX_IMAGE_ORDER; ++order)
+        {
+            double image = fmod(fabs(tone + (double)order * (double)SAMPLE_RATE * rate), (double)SAMPLE_RATE);
+            if (image > (double)SAMPLE_RATE * 0.5)
+                image = (double)SAMPLE_RATE - image;
+            if (fabs(image - tone) < MIN_IMAGE_SPACING)
+                continue;
+            const double level = ToDecibels(FitSine(residual.data(), window, settle, image).amplitude / first.amplitude);
+            out_measurements.imageRejection = std::min(out_measurements.imageRejection, -level);
+        }
+    }
+
+    // The output starts once the shrinking delay has caught up with the input
+    const AkUInt32 aliasSettle = (AkUInt32)((ALIAS_START_DELAY + SETTLE_SECONDS) * SAMPLE_RATE);
+    if (!RenderSine(in_configuration, ALIAS_FREQUENCY, ALIAS_RATE, ALIAS_START_DELAY, ALIAS_START_DELAY + SETTLE_SECONDS + WINDOW_SECONDS, render))
+        return false;
+    const double alias = (double)SAMPLE_RATE - ALIAS_FREQUENCY * (1.0 - ALIAS_RATE);
+    out_measurements.aliasing = ToDecibels(FitSine(&render.output[aliasSettle], window, aliasSettle, alias).amplitude / AMPLITUDE);
+
+    // The fastest of the runs: the others lost time to the rest of the machine
+    double bestSeconds = 0.0;
+    for (int run = 0; run < in_numCPURuns; ++run)
+    {
+        if (!RenderSine(in_configuration, 1000.0, 0.0, BASE_DELAY, CPU_SECONDS, render))
+            return false;
+        if (run == 0 || render.executeSeconds < bestSeconds)
+            bestSeconds = render.executeSeconds;
+    }
+    out_measurements.cpuPercent = bestSeconds / CPU_SECONDS * 100.0;
+    out_measurements.uPeakBytes = render.uPeakBytes;
+    return true;
+}
+
+// ==================== BAND SPLIT ====================
+
+// The band split must not change the response: each step of a sixth-octave sweep goes through the
+// same configuration with and without the crossover, and the gains and phases are compared.
+static const AkUInt32 s_bandSplitCrossovers[] = { 1000, 2000 };
+static const double BAND_SPLIT_GAIN_TOLERANCE = 0.1;    // dB
+static const double BAND_SPLIT_PHASE_TOLERANCE = 1.0;   // Degrees
+
+static bool CheckBandSplit(const MeasureConfiguration& in_configuration, double& out_fGainError, double& out_fPhaseError)
+{
+    const AkUInt32 settle = (AkUInt32)(SETTLE_SECONDS * SAMPLE_RATE);
+    const int window = (int)(WINDOW_SECONDS * SAMPLE_RATE);
+    MeasureConfiguration fullBand = in_configuration;
+    fullBand.bandSplitCrossover = 0;
+    Render split;
+    Render full;
+
+    out_fGainError = 0.0;
+    out_fPhaseError = 0.0;
+    for (int step = 0; ; ++step)
+    {
+        const double frequency = 20.0 * pow(2.0, (double)step / 6.0);
+        if (frequency > 16000.0)
+            break;
+        if (!RenderSine(in_configuration, frequency, 0.0, BASE_DELAY, SETTLE_SECONDS + WINDOW_SECONDS, split)
+            || !RenderSine(fullBand, frequency, 0.0, BASE_DELAY, SETTLE_SECONDS + WINDOW_SECONDS, full))
+            return false;
+
+        const SineFit splitFit = FitSine(&split.output[settle], window, settle, frequency);
+        const SineFit fullFit = FitSine(&full.output[settle], window, settle, frequency);
+        const double gainError = ToDecibels(splitFit.amplitude / fullFit.amplitude);
+        const double phaseError = remainder(splitFit.phase - fullFit.phase, TWO_PI) * 360.0 / TWO_PI;
+        if (fabs(gainError) > fabs(out_fGainError))
+            out_fGainError = gainError;
+        if (fabs(phaseError) > fabs(out_fPhaseError))
+            out_fPhaseError = phaseError;
+    }
+    return true;
+}
+
+// Every upsampling method at 2x and 4x; the ones the cost model rejects for band split run the
+// full band both times and pass trivially
+static bool CheckBandSplits()
+{
+    bool bPassed = true;
+    printf("| Oversampling | Upsampling | Crossover | Gain error | Phase error | Result |\n");
+    printf("|--------------|------------|-----------|------------|-------------|--------|\n");
+    for (AkUInt32 factor = OVERSAMPLE_2X; factor <= OVERSAMPLE_4X; factor *= 2)
+    {
+        for (AkUInt32 upsampling = UPSAMPLE_LINEAR; upsampling <= UPSAMPLE_IIR_HALFBAND; ++upsampling)
+        {
+            for (AkUInt32 crossover : s_bandSplitCrossovers)
+            {
+                const MeasureConfiguration configuration = { nullptr, INTERP_LINEAR, factor, upsampling, crossover };
+                double gainError;
+                double phaseError;
+                if (!CheckBandSplit(configuration, gainError, phaseError))
+                {
+                    fprintf(stderr, "cannot run %s band split at %ux\n", s_upsamplingNames[upsampling], factor);
+                    return false;
+                }
+
+                const bool bMatches = fabs(gainError) <= BAND_SPLIT_GAIN_TOLERANCE && fabs(phaseError) <= BAND_SPLIT_PHASE_TOLERANCE;
+                printf("| %ux | %s | %u Hz | %.2f dB | %.1f degrees | %s |\n",
+                    factor, s_upsamplingNames[upsampling], crossover, gainError, phaseError, bMatches ? "PASS" : "FAIL");
+                fflush(stdout);
+                bPassed = bPassed && bMatches;
+            }
+        }
+    }
+    return bPassed;
+}
+
+// ==================== REPORT ====================
+
+static void PrintHeader(bool in_bTiers)
+{
+    printf("| %s%s | Oversampling | Upsampling | Doppler SNR | Pitch error | Image rejection | Aliasing | THD+N | 10 kHz gain | Sweep | CPU | Memory |\n",
+        in_bTiers ? "Tier | " : "", "Interpolation");
+    printf("|%s---------------|--------------|------------|-------------|-------------|-----------------|----------|-------|-------------|-------|-----|--------|\n",
+        in_bTiers ? "------|" : "");
+}
+
+static void PrintRow(const MeasureConfiguration& in_configuration, const Measurements& in_measurements, bool in_bTiers)
+{
+    const bool bOversampled = in_configuration.oversamplingFactor > OVERSAMPLE_NONE
+        && in_configuration.interpolationType != INTERP_RESAMPLER;
+    const char* pszInterpolation = s_interpolationNames[in_configuration.interpolationType];
+    if (in_bTiers && bOversampled && in_configuration.interpolationType == INTERP_LINEAR)
+        pszInterpolation = "Linear or Hybrid";
+
+    char oversampling[16];
+    snprintf(oversampling, sizeof(oversampling), "%ux", bOversampled ? in_configuration.oversamplingFactor : 1);
+
+    if (in_bTiers)
+        printf("| %s ", in_configuration.pszTier);
+    printf("| %s | %s | %s | %.1f dB | %.3f cents | %.1f dB | %.1f dB | %.1f dB | %.1f dB | %.1f dB | %.2f%% | %.1f MB |\n",
+        pszInterpolation,
+        oversampling,
+        bOversampled ? s_upsamplingNames[in_configuration.upsamplingMethod] : "–",
+        ToTenth(in_measurements.dopplerSNR),
+        fabs(in_measurements.pitchErrorCents),
+        ToTenth(in_measurements.imageRejection),
+        ToTenth(in_measurements.aliasing),
+        ToTenth(in_measurements.thdn),
+        ToTenth(in_measurements.gain10k),
+        ToTenth(in_measurements.sweepDeviation),
+        in_measurements.cpuPercent,
+        (double)in_measurements.uPeakBytes / (1024.0 * 1024.0));
+    fflush(stdout);
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "Usage: FlexibleDelayLinesMeasure [options]\n"
+        "  -a          every interpolation, oversampling and upsampling combination instead of the tiers\n"
+        "  -r <runs>   CPU renders per configuration, the fastest is kept (default: %d)\n"
+        "  -s          check that the band split leaves the response unchanged instead; exits with 1 when it does not\n",
+        DEFAULT_CPU_RUNS);
+}
+
+int main(int argc, char* argv[])
+{
+    bool bAll = false;
+    bool bBandSplit = false;
+    int numCPURuns = DEFAULT_CPU_RUNS;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-a") == 0)
+            bAll = true;
+        else if (strcmp(argv[i], "-s") == 0)
+            bBandSplit = true;
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+            numCPURuns = atoi(argv[++i]);
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (numCPURuns < 1)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (bBandSplit)
+        return CheckBandSplits() ? 0 : 1;
+
+    std::vector<MeasureConfiguration> configurations;
+    if (bAll)
+    {
+        for (AkUInt32 interpolation = INTERP_LINEAR; interpolation <= INTERP_RESAMPLER; ++interpolation)
+        {
+            MeasureConfiguration configuration = { nullptr, interpolation, OVERSAMPLE_NONE, UPSAMPLE_LINEAR, 0 };
+            configurations.push_back(configuration);
+        }
+        // The resampler never oversamples
+        for (AkUInt32 factor = OVERSAMPLE_2X; factor <= OVERSAMPLE_16X; factor *= 2)
+        {
+            for (AkUInt32 upsampling = UPSAMPLE_LINEAR; upsampling <= UPSAMPLE_IIR_HALFBAND; ++upsampling)
+            {
+                for (AkUInt32 interpolation = INTERP_LINEAR; interpolation <= INTERP_HYBRID; ++interpolation)
+                {
+                    MeasureConfiguration configuration = { nullptr, interpolation, factor, upsampling, 0 };
+                    configurations.push_back(configuration);
+                }
+            }
+        }
+    }
+    else
+    {
+        configurations.assign(s_tiers, s_tiers + sizeof(s_tiers) / sizeof(s_tiers[0]));
+    }
+
+    PrintHeader(!bAll);
+    for (const MeasureConfiguration& configuration : configurations)
+    {
+        Measurements measurements;
+        if (!Measure(configuration, numCPURuns, measurements))
+        {
+            fprintf(stderr, "cannot run %s at %ux\n", s_interpolationNames[configuration.interpolationType], configuration.oversamplingFactor);
+            return 1;
+        }
+        PrintRow(configuration, measurements, !bAll);
+    }
+    return 0;
+}
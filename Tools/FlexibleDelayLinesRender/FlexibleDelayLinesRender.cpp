@@ -0,0 +1,652 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+// Offline renderer: runs FlexibleDelayLinesFX over WAV files without the sound engine.
+// Each file gets its own plug-in instance, driven by the same parameter file and
+// rendered in fixed-size buffers; files are spread over a pool of worker threads.
+// With -B it renders each file once per storage format instead, and compares their
+// Execute time, memory and error against the Float32 render.
+
+#include "../Common/FlexibleDelayLinesHost.h"
+
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Normally defined by the sound engine, which the renderer does not link
+AK::PluginRegistration* g_pAKPluginList = nullptr;
+
+static const AkUInt32 DEFAULT_BUFFER_FRAMES = 512;
+static const AkUInt32 MIN_BUFFER_FRAMES = 32;
+static const AkUInt32 MAX_BUFFER_FRAMES = DELAY_PAGE_LEN;   // The paged ring keeps a page of headroom per buffer
+
+static RenderAllocator s_allocator;
+
+// ==================== WAV FILES ====================
+
+struct AudioFile
+{
+    AkUInt32 uSampleRate;
+    AkUInt32 uNumChannels;
+    AkUInt32 uNumFrames;
+    std::vector<float> samples;    // Interleaved
+};
+
+static AkUInt32 ReadLE(const AkUInt8* in_pData, int in_numBytes)
+{
+    AkUInt32 value = 0;
+    for (int i = in_numBytes - 1; i >= 0; --i)
+        value = (value << 8) | in_pData[i];
+    return value;
+}
+
+static void WriteLE(std::vector<AkUInt8>& io_data, AkUInt32 in_value, int in_numBytes)
+{
+    for (int i = 0; i < in_numBytes; ++i)
+        io_data.push_back((AkUInt8)(in_value >> (8 * i)));
+}
+
+// Reads 16, 24 or 32-bit PCM and 32-bit float, plain or WAVE_FORMAT_EXTENSIBLE
+static bool ReadWav(const char* in_pszPath, AudioFile& out_file, std::string& out_error)
+{
+    FILE* pFile = fopen(in_pszPath, "rb");
+    if (pFile == nullptr)
+    {
+        out_error = "cannot open file";
+        return false;
+    }
+
+    std::vector<AkUInt8> data;
+    AkUInt8 chunk[65536];
+    size_t uRead;
+    while ((uRead = fread(chunk, 1, sizeof(chunk), pFile)) > 0)
+        data.insert(data.end(), chunk, chunk + uRead);
+    fclose(pFile);
+
+    if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 || memcmp(&data[8], "WAVE", 4) != 0)
+    {
+        out_error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    AkUInt32 formatTag = 0;
+    AkUInt32 bitsPerSample = 0;
+    const AkUInt8* pSamples = nullptr;
+    size_t uDataSize = 0;
+    out_file.uNumChannels = 0;
+
+    size_t offset = 12;
+    while (offset + 8 <= data.size())
+    {
+        const AkUInt8* pChunk = &data[offset];
+        size_t uChunkSize = ReadLE(pChunk + 4, 4);
+        size_t uAvailable = data.size() - offset - 8;
+        if (uChunkSize > uAvailable)
+            uChunkSize = uAvailable;
+
+        if (memcmp(pChunk, "fmt ", 4) == 0 && uChunkSize >= 16)
+        {
+            formatTag = ReadLE(pChunk + 8, 2);
+            out_file.uNumChannels = ReadLE(pChunk + 10, 2);
+            out_file.uSampleRate = ReadLE(pChunk + 12, 4);
+            bitsPerSample = ReadLE(pChunk + 22, 2);
+
+            // WAVE_FORMAT_EXTENSIBLE: the real format is the first two bytes of the subformat GUID
+            if (formatTag == 0xFFFE && uChunkSize >= 40)
+                formatTag = ReadLE(pChunk + 32, 2);
+        }
+        else if (memcmp(pChunk, "data", 4) == 0)
+        {
+            pSamples = pChunk + 8;
+            uDataSize = uChunkSize;
+        }
+
+        // Chunks are word-aligned
+        offset += 8 + uChunkSize + (uChunkSize & 1);
+    }
+
+    const bool bPCM = formatTag == 1 && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+    const bool bFloat = formatTag == 3 && bitsPerSample == 32;
+    if (pSamples == nullptr || out_file.uNumChannels == 0 || out_file.uSampleRate == 0 || (!bPCM && !bFloat))
+    {
+        out_error = "unsupported format (16/24/32-bit PCM or 32-bit float only)";
+        return false;
+    }
+
+    const AkUInt32 bytesPerSample = bitsPerSample / 8;
+    const size_t uNumSamples = uDataSize / bytesPerSample / out_file.uNumChannels * out_file.uNumChannels;
+    out_file.uNumFrames = (AkUInt32)(uNumSamples / out_file.uNumChannels);
+    out_file.samples.resize(uNumSamples);
+
+    const float scale = 1.0f / (float)(1u << (bitsPerSample - 1));
+    for (size_t i = 0; i < uNumSamples; ++i)
+    {
+        AkUInt32 raw = ReadLE(pSamples + i * bytesPerSample, bytesPerSample);
+        if (bFloat)
+        {
+            memcpy(&out_file.samples[i], &raw, sizeof(float));
+        }
+        else
+        {
+            // Sign-extend from the top of the word
+            AkInt32 value = (AkInt32)(raw << (32 - bitsPerSample)) >> (32 - bitsPerSample);
+            out_file.samples[i] = (float)value * scale;
+        }
+    }
+    return true;
+}
+
+// Always 32-bit float, so nothing the delay line produces gets clipped
+static bool WriteWav(const char* in_pszPath, const AudioFile& in_file)
+{
+    const AkUInt32 uDataSize = (AkUInt32)(in_file.samples.size() * sizeof(float));
+
+    std::vector<AkUInt8> header;
+    header.insert(header.end(), { 'R', 'I', 'F', 'F' });
+    WriteLE(header, 36 + uDataSize, 4);
+    header.insert(header.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+    WriteLE(header, 16, 4);
+    WriteLE(header, 3, 2);
+    WriteLE(header, in_file.uNumChannels, 2);
+    WriteLE(header, in_file.uSampleRate, 4);
+    WriteLE(header, in_file.uSampleRate * in_file.uNumChannels * sizeof(float), 4);
+    WriteLE(header, in_file.uNumChannels * sizeof(float), 2);
+    WriteLE(header, 32, 2);
+    header.insert(header.end(), { 'd', 'a', 't', 'a' });
+    WriteLE(header, uDataSize, 4);
+
+    FILE* pFile = fopen(in_pszPath, "wb");
+    if (pFile == nullptr)
+        return false;
+
+    bool bSuccess = fwrite(header.data(), 1, header.size(), pFile) == header.size();
+    for (size_t i = 0; bSuccess && i < in_file.samples.size(); ++i)
+    {
+        AkUInt32 raw;
+        memcpy(&raw, &in_file.samples[i], sizeof(float));
+        AkUInt8 bytes[4] = { (AkUInt8)raw, (AkUInt8)(raw >> 8), (AkUInt8)(raw >> 16), (AkUInt8)(raw >> 24) };
+        bSuccess = fwrite(bytes, 1, sizeof(bytes), pFile) == sizeof(bytes);
+    }
+    return fclose(pFile) == 0 && bSuccess;
+}
+
+// ==================== PARAMETER FILE ====================
+// One statement per line, '#' starts a comment:
+//   <Name> <value>             sets a parameter for the whole render
+//   @<seconds> <Name> <value>  automation key, RTPC parameters only
+// Names are those of s_parameters. Keys of a parameter are interpolated linearly and
+// the value is held before the first and after the last; like an RTPC it is updated
+// once per buffer.
+
+struct AutomationKey
+{
+    double time;
+    float value;
+};
+
+struct ParameterTrack
+{
+    const ParameterInfo* pInfo;
+    std::vector<AutomationKey> keys;
+
+    float Evaluate(double in_time) const
+    {
+        if (in_time <= keys.front().time)
+            return keys.front().value;
+        if (in_time >= keys.back().time)
+            return keys.back().value;
+
+        size_t next = 1;
+        while (keys[next].time <= in_time)
+            ++next;
+        const AutomationKey& a = keys[next - 1];
+        const AutomationKey& b = keys[next];
+        return a.value + (b.value - a.value) * (float)((in_time - a.time) / (b.time - a.time));
+    }
+};
+
+struct RenderSettings
+{
+    std::vector<ParameterTrack> tracks;
+    AkUInt32 uBufferFrames;
+    float fTailSeconds;
+    std::string outputDirectory;
+    int storageFormat;             // Overrides the parameter file's StorageFormat unless negative
+    int numBenchmarkRuns;          // -B: renders per storage format, 0 to write files instead
+};
+
+static ParameterTrack* FindTrack(RenderSettings& io_settings, const char* in_pszName, std::string& out_error)
+{
+    for (ParameterTrack& track : io_settings.tracks)
+    {
+        if (strcmp(track.pInfo->pszName, in_pszName) == 0)
+            return &track;
+    }
+
+    for (int i = 0; i < NUM_PARAMETER_INFOS; ++i)
+    {
+        if (strcmp(s_parameters[i].pszName, in_pszName) == 0)
+        {
+            ParameterTrack track;
+            track.pInfo = &s_parameters[i];
+            io_settings.tracks.push_back(track);
+            return &io_settings.tracks.back();
+        }
+    }
+
+    out_error = std::string("unknown parameter '") + in_pszName + "'";
+    return nullptr;
+}
+
+static bool ReadParameterFile(const char* in_pszPath, RenderSettings& io_settings, std::string& out_error)
+{
+    FILE* pFile = fopen(in_pszPath, "r");
+    if (pFile == nullptr)
+    {
+        out_error = "cannot open parameter file";
+        return false;
+    }
+
+    char line[512];
+    int lineNumber = 0;
+    bool bSuccess = true;
+    while (bSuccess && fgets(line, sizeof(line), pFile) != nullptr)
+    {
+        ++lineNumber;
+        char* pComment = strchr(line, '#');
+        if (pComment != nullptr)
+            *pComment = '\0';
+
+        char first[128], name[128];
+        float value;
+        int numFields = sscanf(line, "%127s %127s %f", first, name, &value);
+        if (numFields <= 0)
+            continue;
+
+        double time = 0.0;
+        bool bKey = first[0] == '@';
+        if (bKey)
+        {
+            char* pEnd;
+            time = strtod(first + 1, &pEnd);
+            bSuccess = numFields == 3 && *pEnd == '\0' && time >= 0.0;
+        }
+        else
+        {
+            bSuccess = sscanf(line, "%127s %f", name, &value) == 2;
+        }
+
+        ParameterTrack* pTrack = bSuccess ? FindTrack(io_settings, name, out_error) : nullptr;
+        if (pTrack == nullptr)
+        {
+            if (bSuccess)
+                out_error += " at line " + std::to_string(lineNumber);
+            else
+                out_error = "syntax error at line " + std::to_string(lineNumber);
+            bSuccess = false;
+        }
+        else if (bKey && !pTrack->pInfo->bRTPC)
+        {
+            out_error = std::string(name) + " cannot be automated, line " + std::to_string(lineNumber);
+            bSuccess = false;
+        }
+        else if (pTrack->pInfo->bRTPC && !(value >= pTrack->pInfo->fMin && value <= pTrack->pInfo->fMax))
+        {
+            out_error = std::string(name) + " out of range, line " + std::to_string(lineNumber);
+            bSuccess = false;
+        }
+        else
+        {
+            // A plain assignment replaces whatever was there before
+            if (!bKey)
+                pTrack->keys.clear();
+            AutomationKey key = { time, value };
+            pTrack->keys.push_back(key);
+        }
+    }
+    fclose(pFile);
+
+    for (ParameterTrack& track : io_settings.tracks)
+    {
+        std::stable_sort(track.keys.begin(), track.keys.end(),
+            [](const AutomationKey& a, const AutomationKey& b) { return a.time < b.time; });
+    }
+    return bSuccess;
+}
+
+// ==================== RENDERING ====================
+
+// Time spent in Execute only, so that reading the input and writing the output do not count
+static bool RenderFile(const AudioFile& in_input, const RenderSettings& in_settings, AudioFile& out_output, std::string& out_error,
+    double* out_pExecuteSeconds = nullptr)
+{
+    HostedEffect effect(&s_allocator);
+    if (!effect.Create())
+    {
+        out_error = "cannot create the plug-in";
+        return false;
+    }
+
+    // Everything starts at its first key; the non-RTPC settings are read once, by Init
+    FlexibleDelayLinesFXParams* pParams = effect.GetParams();
+    for (const ParameterTrack& track : in_settings.tracks)
+        SetParameter(pParams, *track.pInfo, track.keys.front().value);
+
+    if (in_settings.storageFormat >= 0)
+    {
+        AkUInt32 storageFormat = (AkUInt32)in_settings.storageFormat;
+        pParams->SetParam(PARAM_STORAGEFORMAT_ID, &storageFormat, sizeof(storageFormat));
+    }
+
+    if (!effect.Init(in_input.uSampleRate, in_input.uNumChannels))
+    {
+        out_error = "plug-in initialization failed";
+        return false;
+    }
+
+    const AkUInt32 uNumChannels = in_input.uNumChannels;
+    const AkUInt32 uBufferFrames = in_settings.uBufferFrames;
+    const AkUInt32 uTotalFrames = in_input.uNumFrames + (AkUInt32)(in_settings.fTailSeconds * (float)in_input.uSampleRate);
+
+    out_output.uSampleRate = in_input.uSampleRate;
+    out_output.uNumChannels = uNumChannels;
+    out_output.uNumFrames = uTotalFrames;
+    out_output.samples.assign((size_t)uTotalFrames * uNumChannels, 0.0f);
+
+    std::vector<float> planar((size_t)uBufferFrames * uNumChannels);
+
+    double executeSeconds = 0.0;
+    std::vector<float> lastValues(in_settings.tracks.size());
+    for (size_t i = 0; i < in_settings.tracks.size(); ++i)
+        lastValues[i] = in_settings.tracks[i].keys.front().value;
+
+    for (AkUInt32 start = 0; start < uTotalFrames; start += uBufferFrames)
+    {
+        const AkUInt32 uFrames = uTotalFrames - start < uBufferFrames ? uTotalFrames - start : uBufferFrames;
+
+        // Automation at block rate, only on change so the change handler stays quiet otherwise
+        const double time = (double)start / (double)in_input.uSampleRate;
+        for (size_t i = 0; i < in_settings.tracks.size(); ++i)
+        {
+            const ParameterTrack& track = in_settings.tracks[i];
+            if (track.keys.size() < 2)
+                continue;
+            float value = track.Evaluate(time);
+            if (value != lastValues[i])
+            {
+                SetParameter(pParams, *track.pInfo, value);
+                lastValues[i] = value;
+            }
+        }
+
+        for (AkUInt32 chan = 0; chan < uNumChannels; ++chan)
+        {
+            float* pChannel = &planar[(size_t)chan * uBufferFrames];
+            for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+            {
+                AkUInt32 inputFrame = start + frame;
+                pChannel[frame] = inputFrame < in_input.uNumFrames
+                    ? in_input.samples[(size_t)inputFrame * uNumChannels + chan]
+                    : 0.0f;
+            }
+        }
+
+        executeSeconds += effect.Execute(planar.data(), uBufferFrames, uFrames, start + uFrames >= uTotalFrames);
+
+        for (AkUInt32 chan = 0; chan < uNumChannels; ++chan)
+        {
+            const float* pChannel = &planar[(size_t)chan * uBufferFrames];
+            for (AkUInt32 frame = 0; frame < uFrames; ++frame)
+                out_output.samples[(size_t)(start + frame) * uNumChannels + chan] = pChannel[frame];
+        }
+    }
+
+    if (out_pExecuteSeconds != nullptr)
+        *out_pExecuteSeconds = executeSeconds;
+    return true;
+}
+
+// ==================== STORAGE BENCHMARK ====================
+
+static const char* const s_storageFormatNames[] = { "Float32", "Half", "Int16", "Packed24" };
+static const int NUM_STORAGE_FORMATS = (int)(sizeof(s_storageFormatNames) / sizeof(s_storageFormatNames[0]));
+
+// Renders the input once per storage format, keeping the fastest of the runs, and prints
+// Execute time per frame and channel, the peak memory of the render and the error of each
+// format against Float32. The output files are not written.
+static bool BenchmarkFile(const char* in_pszPath, const AudioFile& in_input, const RenderSettings& in_settings, std::string& out_error)
+{
+    const double seconds = (double)in_input.uNumFrames / (double)in_input.uSampleRate;
+    printf("%s: %u channel(s), %.2f s, %u frames per buffer, best of %d\n",
+        in_pszPath, in_input.uNumChannels, seconds, in_settings.uBufferFrames, in_settings.numBenchmarkRuns);
+    printf("  %-10s %14s %12s %14s %16s\n", "format", "ns/frame/ch", "x realtime", "peak KiB/ch", "error vs Float32");
+
+    AudioFile reference;
+    for (int format = 0; format < NUM_STORAGE_FORMATS; ++format)
+    {
+        RenderSettings settings = in_settings;
+        settings.storageFormat = format;
+
+        AudioFile output;
+        double bestSeconds = 0.0;
+        size_t uPeakBytes = 0;
+        for (int run = 0; run < in_settings.numBenchmarkRuns; ++run)
+        {
+            double executeSeconds;
+            const size_t uBaseBytes = s_allocator.GetLiveBytes();
+            s_allocator.ResetPeak();
+            if (!RenderFile(in_input, settings, output, out_error, &executeSeconds))
+                return false;
+
+            uPeakBytes = s_allocator.GetPeakBytes() - uBaseBytes;
+            if (run == 0 || executeSeconds < bestSeconds)
+                bestSeconds = executeSeconds;
+        }
+
+        const double channelFrames = (double)output.uNumFrames * (double)output.uNumChannels;
+        if (format == 0)
+            reference = output;
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < output.samples.size(); ++i)
+            maxError = std::max(maxError, fabsf(output.samples[i] - reference.samples[i]));
+
+        char error[32];
+        if (format == 0)
+            snprintf(error, sizeof(error), "-");
+        else if (maxError > 0.0f)
+            snprintf(error, sizeof(error), "%.1f dBFS", 20.0f * log10f(maxError));
+        else
+            snprintf(error, sizeof(error), "none");
+
+        printf("  %-10s %14.2f %12.1f %14.1f %16s\n", s_storageFormatNames[format],
+            bestSeconds * 1.0e9 / channelFrames,
+            bestSeconds > 0.0 ? (double)output.uNumFrames / (double)output.uSampleRate / bestSeconds : 0.0,
+            (double)uPeakBytes / 1024.0 / (double)output.uNumChannels,
+            error);
+    }
+    return true;
+}
+
+static std::string GetOutputPath(const std::string& in_inputPath, const RenderSettings& in_settings)
+{
+    size_t separator = in_inputPath.find_last_of("/\\");
+    std::string fileName = separator == std::string::npos ? in_inputPath : in_inputPath.substr(separator + 1);
+    size_t extension = fileName.find_last_of('.');
+    std::string stem = extension == std::string::npos ? fileName : fileName.substr(0, extension);
+
+    if (in_settings.outputDirectory.empty())
+    {
+        std::string directory = separator == std::string::npos ? std::string() : in_inputPath.substr(0, separator + 1);
+        return directory + stem + "_fdl.wav";
+    }
+    return in_settings.outputDirectory + "/" + stem + ".wav";
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "Usage: FlexibleDelayLinesRender [options] <params file> <input.wav>...\n"
+        "  -j <threads>   worker threads (default: one per core)\n"
+        "  -b <frames>    frames per buffer, %u to %u (default: %u)\n"
+        "  -t <seconds>   silence rendered past the end of each input to keep the tail (default: 0)\n"
+        "  -o <dir>       output directory (default: next to each input, as <name>_fdl.wav)\n"
+        "  -B <runs>      compare the four storage formats instead, keeping the fastest of <runs> renders each\n",
+        MIN_BUFFER_FRAMES, MAX_BUFFER_FRAMES, DEFAULT_BUFFER_FRAMES);
+}
+
+int main(int argc, char* argv[])
+{
+    RenderSettings settings;
+    settings.uBufferFrames = DEFAULT_BUFFER_FRAMES;
+    settings.fTailSeconds = 0.0f;
+    settings.storageFormat = -1;
+    settings.numBenchmarkRuns = 0;
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    const char* pszParameterFile = nullptr;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* pszArg = argv[i];
+        const bool bOption = pszArg[0] == '-' && pszArg[1] != '\0' && pszArg[2] == '\0';
+        if (bOption && i + 1 >= argc)
+        {
+            PrintUsage();
+            return 1;
+        }
+
+        if (bOption && pszArg[1] == 'j')
+            numThreads = (unsigned int)atoi(argv[++i]);
+        else if (bOption && pszArg[1] == 'b')
+            settings.uBufferFrames = (AkUInt32)atoi(argv[++i]);
+        else if (bOption && pszArg[1] == 't')
+            settings.fTailSeconds = (float)atof(argv[++i]);
+        else if (bOption && pszArg[1] == 'o')
+            settings.outputDirectory = argv[++i];
+        else if (bOption && pszArg[1] == 'B')
+            settings.numBenchmarkRuns = atoi(argv[++i]);
+        else if (pszArg[0] == '-')
+        {
+            PrintUsage();
+            return 1;
+        }
+        else if (pszParameterFile == nullptr)
+            pszParameterFile = pszArg;
+        else
+            inputs.push_back(pszArg);
+    }
+
+    if (pszParameterFile == nullptr || inputs.empty()
+        || settings.uBufferFrames < MIN_BUFFER_FRAMES || settings.uBufferFrames > MAX_BUFFER_FRAMES
+        || !(settings.fTailSeconds >= 0.0f) || settings.numBenchmarkRuns < 0)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::string error;
+    if (!ReadParameterFile(pszParameterFile, settings, error))
+    {
+        fprintf(stderr, "%s: %s\n", pszParameterFile, error.c_str());
+        return 1;
+    }
+
+    // One file at a time: the other workers would skew the timings
+    if (settings.numBenchmarkRuns > 0)
+    {
+        int numFailed = 0;
+        for (const std::string& inputPath : inputs)
+        {
+            AudioFile input;
+            if (!ReadWav(inputPath.c_str(), input, error) || !BenchmarkFile(inputPath.c_str(), input, settings, error))
+            {
+                fprintf(stderr, "%s: %s\n", inputPath.c_str(), error.c_str());
+                ++numFailed;
+            }
+        }
+        return numFailed > 0 ? 1 : 0;
+    }
+
+    if (numThreads == 0)
+        numThreads = 1;
+    if (numThreads > inputs.size())
+        numThreads = (unsigned int)inputs.size();
+
+    // Files are handed out one at a time so long and short ones balance across the workers
+    std::atomic<size_t> nextInput(0);
+    std::atomic<int> numFailed(0);
+    std::mutex printLock;
+
+    auto worker = [&]()
+    {
+        size_t index;
+        while ((index = nextInput++) < inputs.size())
+        {
+            const std::string& inputPath = inputs[index];
+            std::string outputPath = GetOutputPath(inputPath, settings);
+            std::string jobError;
+
+            AudioFile input, output;
+            bool bSuccess = ReadWav(inputPath.c_str(), input, jobError)
+                && RenderFile(input, settings, output, jobError);
+            if (bSuccess && !WriteWav(outputPath.c_str(), output))
+            {
+                jobError = "cannot write " + outputPath;
+                bSuccess = false;
+            }
+
+            std::lock_guard<std::mutex> lock(printLock);
+            if (bSuccess)
+            {
+                printf("%s -> %s\n", inputPath.c_str(), outputPath.c_str());
+            }
+            else
+            {
+                fprintf(stderr, "%s: %s\n", inputPath.c_str(), jobError.c_str());
+                ++numFailed;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numThreads; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    return numFailed > 0 ? 1 : 0;
+}
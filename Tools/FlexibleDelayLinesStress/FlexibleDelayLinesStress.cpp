@@ -0,0 +1,452 @@
+/*******************************************************************************
+The content of this file includes portions of the AUDIOKINETIC Wwise Technology
+released in source code form as part of the SDK installer package.
+
+Commercial License Usage
+
+Licensees holding valid commercial licenses to the AUDIOKINETIC Wwise Technology
+may use this file in accordance with the end user license agreement provided
+with the software or, alternatively, in accordance with the terms contained in a
+written agreement between you and Audiokinetic Inc.
+
+Apache License Usage
+
+Alternatively, this file may be used under the Apache License, Version 2.0 (the
+"Apache License"); you may not use this file except in compliance with the
+Apache License. You may obtain a copy of the Apache License at
+http://www.apache.org/licenses/LICENSE-2.0.
+
+Unless required by applicable law or agreed to in writing, software distributed
+under the Apache License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+OR CONDITIONS OF ANY KIND, either express or implied. See the Apache License for
+the specific language governing permissions and limitations under the License.
+
+  Copyright (c) 2025 Audiokinetic Inc.
+*******************************************************************************/
+
+// Stress harness: runs FlexibleDelayLinesFX through a set of configurations while throwing
+// at it, between buffers, what the game and the sound engine can: RTPC updates at random and
+// extreme values, bank reloads (SetParamsBlock), delay curves, distance jumps across the whole
+// range, Reset, and stretches of virtual voice (TimeSkip instead of Execute).
+// Every Execute is timed by FlexibleDelayLinesFXProfiler against its buffer period. A
+// configuration passes when its output stays finite and bounded and its memory all comes back
+// on Term; the exit code is 1 when any configuration fails. A p999 load over
+// FLEXIBLEDELAYLINES_PROFILE_BUDGET is flagged but does not fail the run: it depends on the
+// machine and on what else runs on it. The events come from a seeded generator, so a failure
+// replays with the same -s, unless -w moves the parameter writes to their own thread.
+
+#include "../Common/FlexibleDelayLinesHost.h"
+#include "../../SoundEnginePlugin/FlexibleDelayLinesFXProfiler.h"
+
+#include <atomic>
+#include <math.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Normally defined by the sound engine, which the harness does not link
+AK::PluginRegistration* g_pAKPluginList = nullptr;
+
+static const AkUInt32 SAMPLE_RATE = 48000;
+static const AkUInt32 DEFAULT_BUFFER_FRAMES = 512;
+static const AkUInt32 MIN_BUFFER_FRAMES = 32;
+static const AkUInt32 MAX_BUFFER_FRAMES = DELAY_PAGE_LEN;   // The paged ring keeps a page of headroom per buffer
+static const float DEFAULT_SECONDS = 120.0f;               // Of audio per configuration
+static const float MAX_OUTPUT_LEVEL = 1000.0f;             // +60 dBFS: feedback at 0.95 on full-scale noise stays far below
+
+static RenderAllocator s_allocator;
+
+// ==================== CONFIGURATIONS ====================
+
+struct StressConfiguration
+{
+    const char* pszName;
+    AkUInt32 uNumChannels;      // FDN lines for the feedback matrices
+    FlexibleDelayLinesNonRTPCParams settings;
+};
+
+// Settings in FlexibleDelayLinesNonRTPCParams order: interpolation, oversampling, upsampling,
+// storage, memory mode, decimation, filter phase, distance source, listener, feedback matrix,
+// DC blocker, distance effects, virtual snapshot, max delay time (ms), band split crossover (Hz)
+static const StressConfiguration s_configurations[] =
+{
+    { "1x Linear",                  2, { 0,  1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,  0,    0 } },
+    { "1x Hybrid Int16",            2, { 3,  1, 0, 2, 0, 1, 0, 0, 0, 0, 0, 3, 0,  0,    0 } },
+    { "1x Resampler",               2, { 4,  1, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0,  0,    0 } },
+    { "1x short ring",              2, { 2,  1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 20,    0 } },
+    { "4x Polyphase Half",          2, { 0,  4, 2, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0,  0,    0 } },
+    { "4x Polyphase band split",    2, { 0,  4, 2, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0,  0, 2000 } },
+    { "8x IIR Half-band",           2, { 3,  8, 3, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0,  0,    0 } },
+    { "16x Polyphase min phase",    1, { 0, 16, 2, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0,  0,    0 } },
+    { "Paged Packed24 snapshot",    2, { 0,  1, 0, 3, 1, 1, 0, 0, 0, 0, 0, 0, 1,  0,    0 } },
+    { "Pooled Half snapshot",       2, { 2,  1, 0, 1, 2, 1, 0, 0, 0, 0, 0, 0, 2,  0,    0 } },
+    { "Pooled 2x Polyphase",        2, { 0,  2, 2, 0, 2, 1, 0, 0, 0, 0, 0, 0, 0,  0,    0 } },
+    { "Decimated 4x",               2, { 0,  1, 0, 0, 0, 4, 0, 0, 0, 0, 1, 0, 0,  0,    0 } },
+    { "FDN Householder",            6, { 0,  1, 0, 0, 0, 1, 0, 0, 0, 1, 1, 3, 0,  0,    0 } },
+    { "FDN Hadamard",               8, { 3,  1, 0, 2, 0, 1, 0, 0, 0, 2, 1, 0, 0,  0,    0 } },
+};
+
+static const int NUM_CONFIGURATIONS = (int)(sizeof(s_configurations) / sizeof(s_configurations[0]));
+
+// ==================== PARAMETER EVENTS ====================
+
+// Per buffer, the chance of each event
+static const float RTPC_CHANCE = 0.5f;
+static const float EXTREME_CHANCE = 0.1f;           // Of an RTPC landing on an end of its range
+static const float DISTANCE_JUMP_CHANCE = 0.02f;
+static const float PARAMS_BLOCK_CHANCE = 0.01f;
+static const float DELAY_CURVE_CHANCE = 0.01f;
+static const float RESET_CHANCE = 0.005f;
+static const float VIRTUAL_CHANCE = 0.01f;
+static const float INPUT_CHANGE_CHANCE = 0.02f;
+static const int MAX_VIRTUAL_BUFFERS = 50;
+
+class StressEvents
+{
+    static const int NUM_RTPC_INFOS = 10;   // The RTPC entries lead s_parameters
+
+public:
+    explicit StressEvents(AkUInt32 in_uSeed) : m_random(in_uSeed) {}
+
+    float Uniform(float in_fMin, float in_fMax)
+    {
+        return std::uniform_real_distribution<float>(in_fMin, in_fMax)(m_random);
+    }
+
+    bool Chance(float in_fChance)
+    {
+        return Uniform(0.0f, 1.0f) < in_fChance;
+    }
+
+    int Integer(int in_min, int in_max)
+    {
+        return std::uniform_int_distribution<int>(in_min, in_max)(m_random);
+    }
+
+    float RandomValue(const ParameterInfo& in_info)
+    {
+        if (Chance(EXTREME_CHANCE))
+            return Chance(0.5f) ? in_info.fMin : in_info.fMax;
+        return Uniform(in_info.fMin, in_info.fMax);
+    }
+
+    /// Everything the game may send before the next buffer. Single writer: the caller owns the
+    /// parameter node for the duration, as the sound engine serializes calls on it.
+    void DriveParameters(FlexibleDelayLinesFXParams* io_pParams, const FlexibleDelayLinesNonRTPCParams& in_settings)
+    {
+        if (Chance(RTPC_CHANCE))
+        {
+            const int numUpdates = Integer(1, 3);
+            for (int i = 0; i < numUpdates; ++i)
+            {
+                const ParameterInfo& info = s_parameters[Integer(0, NUM_RTPC_INFOS - 1)];
+                SetParameter(io_pParams, info, RandomValue(info));
+            }
+        }
+
+        // From one end of the range to the other in one buffer: the largest delay jump there is
+        if (Chance(DISTANCE_JUMP_CHANCE))
+        {
+            AkReal32 distance = m_bFar ? 0.0f : 450.0f;
+            m_bFar = !m_bFar;
+            io_pParams->SetParam(PARAM_DISTANCE_ID, &distance, sizeof(distance));
+        }
+
+        if (Chance(PARAMS_BLOCK_CHANCE))
+            SendParamsBlock(io_pParams, in_settings);
+
+        if (Chance(DELAY_CURVE_CHANCE))
+            SendDelayCurve(io_pParams);
+    }
+
+    // What a bank reload sends: random RTPC values, the configuration's settings unchanged
+    // since only Init reads those
+    void SendParamsBlock(FlexibleDelayLinesFXParams* io_pParams, const FlexibleDelayLinesNonRTPCParams& in_settings)
+    {
+        AkUInt8 block[sizeof(AkReal32) * NUM_RTPC_INFOS + sizeof(FlexibleDelayLinesNonRTPCParams)];
+        for (int i = 0; i < NUM_RTPC_INFOS; ++i)
+        {
+            AkReal32 value = RandomValue(s_parameters[i]);
+            memcpy(block + sizeof(AkReal32) * i, &value, sizeof(value));
+        }
+        memcpy(block + sizeof(AkReal32) * NUM_RTPC_INFOS, &in_settings, sizeof(in_settings));
+        io_pParams->SetParamsBlock(block, sizeof(block));
+    }
+
+private:
+    void SendDelayCurve(FlexibleDelayLinesFXParams* io_pParams)
+    {
+        FlexibleDelayLinesDelayCurve curve;
+        curve.uValueType = Chance(0.5f) ? DELAY_CURVE_DELAYTIME : DELAY_CURVE_DISTANCE;
+        curve.uNumPoints = (AkUInt32)Integer(1, (int)DELAY_CURVE_MAX_POINTS);
+        const ParameterInfo& range = s_parameters[curve.uValueType == DELAY_CURVE_DELAYTIME ? 0 : 3];
+
+        float time = 0.0f;
+        for (AkUInt32 i = 0; i < curve.uNumPoints; ++i)
+        {
+            time += Uniform(0.001f, 0.5f);
+            curve.points[i].fTime = time;
+            curve.points[i].fValue = RandomValue(range);
+        }
+
+        const AkUInt32 uSize = sizeof(AkUInt32) * 2 + curve.uNumPoints * sizeof(FlexibleDelayLinesCurvePoint);
+        io_pParams->SetParam(PARAM_DELAYCURVE_ID, &curve, uSize);
+    }
+
+    std::mt19937 m_random;
+    bool m_bFar = false;
+};
+
+// ==================== RUNNING ====================
+
+struct StressSettings
+{
+    AkUInt32 uBufferFrames;
+    float fSeconds;
+    AkUInt32 uSeed;
+    bool bWriterThread;            // -w: parameter writes from a second thread, racing Execute
+    std::string filter;            // Only the configurations whose name contains it
+};
+
+struct StressResult
+{
+    AkUInt64 uNumCalls;
+    float p50, p99, p999, max;
+    float fPeakLevel;              // Largest output sample, 0 when it was not finite
+    bool bFinite;
+    bool bLeak;
+    bool bInitFailed;
+};
+
+static void FillInput(float* out_pPlanar, AkUInt32 in_uBufferFrames, AkUInt32 in_uNumChannels, float in_fLevel, StressEvents& io_events)
+{
+    for (AkUInt32 chan = 0; chan < in_uNumChannels; ++chan)
+    {
+        float* pChannel = out_pPlanar + (size_t)chan * in_uBufferFrames;
+        for (AkUInt32 frame = 0; frame < in_uBufferFrames; ++frame)
+            pChannel[frame] = in_fLevel * io_events.Uniform(-1.0f, 1.0f);
+    }
+}
+
+static StressResult RunConfiguration(const StressConfiguration& in_configuration, const StressSettings& in_settings)
+{
+    StressResult result = {};
+    result.bFinite = true;
+
+    const size_t uBaseBytes = s_allocator.GetLiveBytes();
+    const AkUInt32 uNumChannels = in_configuration.uNumChannels;
+    const AkUInt32 uBufferFrames = in_settings.uBufferFrames;
+    const AkUInt64 uNumBuffers = (AkUInt64)(in_settings.fSeconds * (float)SAMPLE_RATE) / uBufferFrames;
+
+    FlexibleDelayLinesFXProfiler profiler;
+    {
+        HostedEffect effect(&s_allocator);
+        StressEvents events(in_settings.uSeed);
+        if (!effect.Create())
+        {
+            result.bInitFailed = true;
+            return result;
+        }
+
+        // Loaded like a bank: random RTPC values, the configuration's settings
+        FlexibleDelayLinesFXParams* pParams = effect.GetParams();
+        const FlexibleDelayLinesNonRTPCParams& settings = in_configuration.settings;
+        events.SendParamsBlock(pParams, settings);
+
+        if (!effect.Init(SAMPLE_RATE, uNumChannels))
+        {
+            result.bInitFailed = true;
+            return result;
+        }
+
+        // With -w the writer owns the parameter node and the generator it draws from
+        std::atomic<bool> bStop(false);
+        StressEvents writerEvents(in_settings.uSeed ^ 0x9E3779B9u);
+        std::thread writer;
+        if (in_settings.bWriterThread)
+        {
+            writer = std::thread([&]()
+            {
+                while (!bStop.load(std::memory_order_relaxed))
+                {
+                    writerEvents.DriveParameters(pParams, settings);
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        std::vector<float> planar((size_t)uBufferFrames * uNumChannels);
+        float inputLevel = 1.0f;
+        int virtualBuffers = 0;
+        for (AkUInt64 buffer = 0; buffer < uNumBuffers; ++buffer)
+        {
+            if (!in_settings.bWriterThread)
+                events.DriveParameters(pParams, settings);
+
+            if (virtualBuffers > 0)
+            {
+                effect.TimeSkip(uBufferFrames);
+                --virtualBuffers;
+                continue;
+            }
+            if (events.Chance(VIRTUAL_CHANCE))
+                virtualBuffers = events.Integer(1, MAX_VIRTUAL_BUFFERS);
+            if (events.Chance(RESET_CHANCE))
+                effect.Reset();
+
+            // Full scale, quiet, silent (the tail only) or single clicks
+            if (events.Chance(INPUT_CHANGE_CHANCE))
+            {
+                const float levels[4] = { 1.0f, 0.01f, 0.0f, -1.0f };
+                inputLevel = levels[events.Integer(0, 3)];
+            }
+            if (inputLevel >= 0.0f)
+            {
+                FillInput(planar.data(), uBufferFrames, uNumChannels, inputLevel, events);
+            }
+            else
+            {
+                memset(planar.data(), 0, planar.size() * sizeof(float));
+                for (AkUInt32 chan = 0; chan < uNumChannels; ++chan)
+                    planar[(size_t)chan * uBufferFrames + (AkUInt32)events.Integer(0, (int)uBufferFrames - 1)] = 1.0f;
+            }
+
+            profiler.Begin();
+            effect.Execute(planar.data(), uBufferFrames, uBufferFrames, false);
+            profiler.End(uBufferFrames, (float)SAMPLE_RATE);
+
+            for (float sample : planar)
+            {
+                if (!(fabsf(sample) <= MAX_OUTPUT_LEVEL))
+                    result.bFinite = false;
+                else if (fabsf(sample) > result.fPeakLevel)
+                    result.fPeakLevel = fabsf(sample);
+            }
+        }
+
+        bStop = true;
+        if (writer.joinable())
+            writer.join();
+    }
+
+    result.uNumCalls = profiler.GetNumCalls();
+    result.p50 = profiler.GetLoadPercentile(0.5f);
+    result.p99 = profiler.GetLoadPercentile(0.99f);
+    result.p999 = profiler.GetLoadPercentile(0.999f);
+    result.max = profiler.GetMaxLoad();
+    result.bLeak = s_allocator.GetLiveBytes() != uBaseBytes;
+    return result;
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "Usage: FlexibleDelayLinesStress [options] [configuration filter]\n"
+        "  -b <frames>    frames per buffer, %u to %u (default: %u)\n"
+        "  -d <seconds>   audio per configuration (default: %.0f)\n"
+        "  -s <seed>      seed of the random events (default: 1)\n"
+        "  -w             write the parameters from a second thread while Execute runs\n"
+        "  -l             list the configurations\n"
+        "Runs every configuration whose name contains the filter, all of them by default.\n"
+        "Exits with 1 when one fails: output not finite or over %.0f, or memory not returned.\n"
+        "An Execute p999 over %.2f%% of the buffer period (FLEXIBLEDELAYLINES_PROFILE_BUDGET) is flagged.\n",
+        MIN_BUFFER_FRAMES, MAX_BUFFER_FRAMES, DEFAULT_BUFFER_FRAMES, DEFAULT_SECONDS,
+        MAX_OUTPUT_LEVEL, FLEXIBLEDELAYLINES_PROFILE_BUDGET * 100.0f);
+}
+
+int main(int argc, char* argv[])
+{
+    StressSettings settings;
+    settings.uBufferFrames = DEFAULT_BUFFER_FRAMES;
+    settings.fSeconds = DEFAULT_SECONDS;
+    settings.uSeed = 1;
+    settings.bWriterThread = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* pszArg = argv[i];
+        const bool bOption = pszArg[0] == '-' && pszArg[1] != '\0' && pszArg[2] == '\0';
+        const bool bHasValue = bOption && i + 1 < argc;
+
+        if (bOption && pszArg[1] == 'w')
+            settings.bWriterThread = true;
+        else if (bOption && pszArg[1] == 'l')
+        {
+            for (int config = 0; config < NUM_CONFIGURATIONS; ++config)
+                printf("%s (%u channels)\n", s_configurations[config].pszName, s_configurations[config].uNumChannels);
+            return 0;
+        }
+        else if (bHasValue && pszArg[1] == 'b')
+            settings.uBufferFrames = (AkUInt32)atoi(argv[++i]);
+        else if (bHasValue && pszArg[1] == 'd')
+            settings.fSeconds = (float)atof(argv[++i]);
+        else if (bHasValue && pszArg[1] == 's')
+            settings.uSeed = (AkUInt32)strtoul(argv[++i], nullptr, 10);
+        else if (pszArg[0] == '-' || !settings.filter.empty())
+        {
+            PrintUsage();
+            return 1;
+        }
+        else
+            settings.filter = pszArg;
+    }
+
+    if (settings.uBufferFrames < MIN_BUFFER_FRAMES || settings.uBufferFrames > MAX_BUFFER_FRAMES
+        || !(settings.fSeconds > 0.0f))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    printf("%.0f s per configuration, %u frames per buffer at %u Hz, seed %u%s, budget p999 %.2f%%\n",
+        settings.fSeconds, settings.uBufferFrames, SAMPLE_RATE, settings.uSeed,
+        settings.bWriterThread ? ", writer thread" : "", FLEXIBLEDELAYLINES_PROFILE_BUDGET * 100.0f);
+    printf("  %-28s %8s %8s %8s %8s %8s %10s  %s\n", "configuration", "calls", "p50 %", "p99 %", "p999 %", "max %", "peak dB", "result");
+
+    int numRun = 0;
+    int numFailed = 0;
+    int numOverBudget = 0;
+    for (int config = 0; config < NUM_CONFIGURATIONS; ++config)
+    {
+        const StressConfiguration& configuration = s_configurations[config];
+        if (!settings.filter.empty() && strstr(configuration.pszName, settings.filter.c_str()) == nullptr)
+            continue;
+        ++numRun;
+
+        const StressResult result = RunConfiguration(configuration, settings);
+        std::string failure;
+        if (result.bInitFailed)
+            failure = "init failed";
+        else if (!result.bFinite)
+            failure = "output not finite or out of range";
+        else if (result.bLeak)
+            failure = "memory not returned";
+
+        // Timing is reported, not gated on
+        const bool bOverBudget = failure.empty() && result.p999 > FLEXIBLEDELAYLINES_PROFILE_BUDGET;
+
+        printf("  %-28s %8llu %8.3f %8.3f %8.3f %8.3f %10.1f  %s%s\n", configuration.pszName,
+            (unsigned long long)result.uNumCalls,
+            result.p50 * 100.0f, result.p99 * 100.0f, result.p999 * 100.0f, result.max * 100.0f,
+            result.fPeakLevel > 0.0f ? 20.0f * log10f(result.fPeakLevel) : -INFINITY,
+            failure.empty() ? (bOverBudget ? "PASS, p999 over budget" : "PASS") : "FAIL: ", failure.c_str());
+        if (!failure.empty())
+            ++numFailed;
+        if (bOverBudget)
+            ++numOverBudget;
+    }
+
+    if (numRun == 0)
+    {
+        fprintf(stderr, "no configuration matches '%s'\n", settings.filter.c_str());
+        return 1;
+    }
+
+    printf("%d of %d configuration(s) passed, %d with a p999 over budget\n", numRun - numFailed, numRun, numOverBudget);
+    return numFailed > 0 ? 1 : 0;
+}
@@ -26,8 +26,111 @@ the specific language governing permissions and limitations under the License.
 
 #include "FlexibleDelayLinesPlugin.h"
 #include "../SoundEnginePlugin/FlexibleDelayLinesFXFactory.h"
+#include "../SoundEnginePlugin/FlexibleDelayLinesFXCostModel.h"
+#include "../SoundEnginePlugin/FlexibleDelayLinesFXFilterDesign.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ShareSets estimated above either budget get a warning. The channel count is an
+// assumption: the authoring plug-in does not know the format of the bus it will run on.
+#ifndef FLEXIBLEDELAYLINES_MEMORY_BUDGET
+#define FLEXIBLEDELAYLINES_MEMORY_BUDGET (16 * 1024 * 1024)
+#endif
+#ifndef FLEXIBLEDELAYLINES_CPU_BUDGET
+#define FLEXIBLEDELAYLINES_CPU_BUDGET 48.0f    // In 1x Linear channels, about 1.2% of a core
+#endif
+#ifndef FLEXIBLEDELAYLINES_BUDGET_CHANNELS
+#define FLEXIBLEDELAYLINES_BUDGET_CHANNELS 2
+#endif
+
+static const float ESTIMATE_SAMPLE_RATE = 48000.0f;
+static const float ESTIMATE_SPEED_OF_SOUND = 343.0f;   // Distance maps to the round trip, as in the sound engine
+
+// The minimum-phase design needs scratch memory; it only ever asks for plain blocks
+class FilterDesignAllocator : public AK::IAkPluginMemAlloc
+{
+public:
+    void* Malloc(size_t in_uSize, const char*, AkUInt32) override { return malloc(in_uSize); }
+    void Free(void* in_pMemAddress) override { free(in_pMemAddress); }
+    void* Malign(size_t, size_t, const char*, AkUInt32) override { return nullptr; }
+    void* Realloc(void* in_pMemAddress, size_t in_uSize, const char*, AkUInt32) override { return realloc(in_pMemAddress, in_uSize); }
+    void* ReallocAligned(void*, size_t, size_t, const char*, AkUInt32) override { return nullptr; }
+};
+
+// Designs the filters an instance with these settings would design at Init, exactly as it would,
+// and writes them after the scalars (see FlexibleDelayLinesFilterTables for the layout)
+static void WriteFilterTables(const FlexibleDelayLinesEffectiveSettings& in_settings, AkUInt32 in_filterPhase, AK::Wwise::Plugin::DataWriter& in_dataWriter)
+{
+    FlexibleDelayLinesFilterTables tables;
+    tables.uOversampleFactor = (AkUInt32)in_settings.oversampleFactor;
+    tables.uUpsamplingMethod = in_settings.upsamplingMethod;
+    tables.uFilterPhase = in_filterPhase;
+    tables.uDecimationFactor = (AkUInt32)in_settings.decimationFactor;
+
+    DesignPowerComplementaryTable(tables.powerComplementary, FILTER_TABLES_POWERCOMP_LEN);
+
+    tables.uFIRLength = 0;
+    if (in_settings.upsamplingMethod == UPSAMPLE_POLYPHASE && in_settings.oversampleFactor > OVERSAMPLE_NONE)
+    {
+        const int length = 8 * in_settings.oversampleFactor;
+        if (length <= (int)FILTER_TABLES_MAX_FIR_LEN)
+        {
+            DesignLowpassFIR(tables.fir, length, 0.5f / (float)in_settings.oversampleFactor);
+            tables.uFIRLength = (AkUInt32)length;
+
+            // If the design fails, leave the FIR out so the sound engine tries again
+            FilterDesignAllocator allocator;
+            if (in_filterPhase == FILTER_PHASE_MINIMUM && !DesignMinimumPhaseFIR(tables.fir, tables.fir, length, &allocator))
+                tables.uFIRLength = 0;
+        }
+    }
+
+    int halfbandNumCoefs[HALFBAND_CASCADE_MAX_STAGES];
+    tables.uHalfbandNumStages = 0;
+    if (in_settings.upsamplingMethod == UPSAMPLE_IIR_HALFBAND)
+    {
+        tables.uHalfbandNumStages = (AkUInt32)DesignHalfbandCascade(in_settings.oversampleFactor, halfbandNumCoefs, tables.halfbandCoefs);
+        for (AkUInt32 stage = 0; stage < tables.uHalfbandNumStages; ++stage)
+            tables.halfbandNumCoefs[stage] = (AkUInt32)halfbandNumCoefs[stage];
+    }
+
+    tables.uDecimationFIRLength = 0;
+    if (in_settings.decimationFactor > DECIMATE_NONE)
+    {
+        tables.uDecimationFIRLength = (AkUInt32)(16 * in_settings.decimationFactor + 1);
+        DesignLowpassFIR(tables.decimationFIR, (int)tables.uDecimationFIRLength, 0.45f / (float)in_settings.decimationFactor);
+    }
+
+    in_dataWriter.WriteUInt32(FILTER_TABLES_TAG);
+    in_dataWriter.WriteUInt32(FILTER_TABLES_VERSION);
+    in_dataWriter.WriteUInt32(tables.uOversampleFactor);
+    in_dataWriter.WriteUInt32(tables.uUpsamplingMethod);
+    in_dataWriter.WriteUInt32(tables.uFilterPhase);
+    in_dataWriter.WriteUInt32(tables.uDecimationFactor);
+    for (AkUInt32 i = 0; i < FILTER_TABLES_POWERCOMP_LEN; ++i)
+        in_dataWriter.WriteReal32(tables.powerComplementary[i]);
+
+    in_dataWriter.WriteUInt32(tables.uFIRLength);
+    for (AkUInt32 i = 0; i < tables.uFIRLength; ++i)
+        in_dataWriter.WriteReal32(tables.fir[i]);
+
+    in_dataWriter.WriteUInt32(tables.uHalfbandNumStages);
+    for (AkUInt32 stage = 0; stage < tables.uHalfbandNumStages; ++stage)
+    {
+        in_dataWriter.WriteUInt32(tables.halfbandNumCoefs[stage]);
+        for (AkUInt32 i = 0; i < tables.halfbandNumCoefs[stage]; ++i)
+            in_dataWriter.WriteReal32(tables.halfbandCoefs[stage][i]);
+    }
+
+    in_dataWriter.WriteUInt32(tables.uDecimationFIRLength);
+    for (AkUInt32 i = 0; i < tables.uDecimationFIRLength; ++i)
+        in_dataWriter.WriteReal32(tables.decimationFIR[i]);
+}
 
 FlexibleDelayLinesPlugin::FlexibleDelayLinesPlugin()
+    : m_bOverBudget(false)
 {
 }
 
@@ -35,6 +138,102 @@ FlexibleDelayLinesPlugin::~FlexibleDelayLinesPlugin()
 {
 }
 
+FlexibleDelayLinesNonRTPCParams FlexibleDelayLinesPlugin::GetNonRTPCParams(const GUID & in_guidPlatform) const
+{
+    FlexibleDelayLinesNonRTPCParams params;
+    params.interpolationType = m_propertySet.GetUInt32(in_guidPlatform, "InterpolationType");
+    params.oversamplingFactor = m_propertySet.GetUInt32(in_guidPlatform, "OversamplingFactor");
+    params.upsamplingMethod = m_propertySet.GetUInt32(in_guidPlatform, "UpsamplingMethod");
+    params.storageFormat = m_propertySet.GetUInt32(in_guidPlatform, "StorageFormat");
+    params.delayMemoryMode = m_propertySet.GetUInt32(in_guidPlatform, "DelayMemoryMode");
+    params.decimationFactor = m_propertySet.GetUInt32(in_guidPlatform, "DecimationFactor");
+    params.filterPhase = m_propertySet.GetUInt32(in_guidPlatform, "FilterPhase");
+    params.distanceSource = m_propertySet.GetUInt32(in_guidPlatform, "DistanceSource");
+    params.listenerIndex = m_propertySet.GetUInt32(in_guidPlatform, "ListenerIndex");
+    params.feedbackMatrix = m_propertySet.GetUInt32(in_guidPlatform, "FeedbackMatrix");
+    params.dcBlocker = m_propertySet.GetUInt32(in_guidPlatform, "DCBlocker");
+    params.distanceEffects = m_propertySet.GetUInt32(in_guidPlatform, "DistanceEffects");
+    params.virtualSnapshot = m_propertySet.GetUInt32(in_guidPlatform, "VirtualSnapshot");
+    params.maxDelayTime = GetMaxDelayTime(in_guidPlatform);
+    params.bandSplitCrossover = m_propertySet.GetUInt32(in_guidPlatform, "BandSplitCrossover");
+    return params;
+}
+
+AkUInt32 FlexibleDelayLinesPlugin::GetMaxDelayTime(const GUID & in_guidPlatform) const
+{
+    const AkUInt32 maxDelayTime = m_propertySet.GetUInt32(in_guidPlatform, "MaxDelayTime");
+    if (maxDelayTime > 0)
+        return maxDelayTime;
+
+    // Authoring plug-ins cannot read RTPC curves: a delay under an RTPC or following a listener
+    // stays unknown, and keeps the full ring. Otherwise the authored value is the only delay;
+    // a delay curve sent by the game past it is clamped, and the sound engine reports it.
+    if (m_propertySet.GetUInt32(in_guidPlatform, "DistanceSource") != DISTANCE_SOURCE_RTPC
+        || m_propertySet.PropertyHasRTPC("DelayTime")
+        || m_propertySet.PropertyHasRTPC("Distance")
+        || m_propertySet.PropertyHasRTPC("DelaySpread"))
+        return 0;
+
+    const float distance = m_propertySet.GetReal32(in_guidPlatform, "Distance");
+    float delayTime = distance > 0.0f
+        ? distance * 2.0f / ESTIMATE_SPEED_OF_SOUND
+        : m_propertySet.GetReal32(in_guidPlatform, "DelayTime");
+
+    // The longest FDN line
+    if (m_propertySet.GetUInt32(in_guidPlatform, "FeedbackMatrix") != FEEDBACK_MATRIX_NONE)
+        delayTime *= 1.0f + m_propertySet.GetReal32(in_guidPlatform, "DelaySpread");
+
+    // Rounded up, and a millisecond over so the float conversions never land past it
+    return (AkUInt32)(delayTime * 1000.0f) + 2;
+}
+
+FlexibleDelayLinesCostEstimate FlexibleDelayLinesPlugin::EstimateCost(const GUID & in_guidPlatform) const
+{
+    // Only paged rings depend on the delay; the authored value stands in for the RTPC range
+    const float distance = m_propertySet.GetReal32(in_guidPlatform, "Distance");
+    const float delayTime = distance > 0.0f
+        ? distance * 2.0f / ESTIMATE_SPEED_OF_SOUND
+        : m_propertySet.GetReal32(in_guidPlatform, "DelayTime");
+
+    return ::EstimateCost(ResolveEffectiveSettings(GetNonRTPCParams(in_guidPlatform), ESTIMATE_SAMPLE_RATE), delayTime, ESTIMATE_SAMPLE_RATE);
+}
+
+void FlexibleDelayLinesPlugin::NotifyPropertyChanged(const GUID & in_guidPlatform, const char * in_szPropertyName)
+{
+    // The wet mix, feedback and filters cost the same at any value
+    static const char* const s_costProperties[] =
+    {
+        "DelayTime", "Distance", "InterpolationType", "OversamplingFactor", "UpsamplingMethod",
+        "StorageFormat", "DelayMemoryMode", "DecimationFactor", "FeedbackMatrix", "DistanceEffects",
+        "MaxDelayTime", "BandSplitCrossover", "DistanceSource", "DelaySpread"
+    };
+
+    bool bCostProperty = false;
+    for (const char* pszName : s_costProperties)
+        bCostProperty = bCostProperty || strcmp(pszName, in_szPropertyName) == 0;
+    if (!bCostProperty)
+        return;
+
+    const FlexibleDelayLinesCostEstimate estimate = EstimateCost(in_guidPlatform);
+    const float megabytes = (float)estimate.uBytesPerChannel * FLEXIBLEDELAYLINES_BUDGET_CHANNELS / (1024.0f * 1024.0f);
+    const float cpu = estimate.fCPUPerChannel * FLEXIBLEDELAYLINES_BUDGET_CHANNELS;
+    const bool bOverBudget = (float)estimate.uBytesPerChannel * FLEXIBLEDELAYLINES_BUDGET_CHANNELS > (float)FLEXIBLEDELAYLINES_MEMORY_BUDGET
+        || cpu > FLEXIBLEDELAYLINES_CPU_BUDGET;
+
+    // Warn on every costly change while over budget, and once when back under
+    if (bOverBudget || m_bOverBudget)
+    {
+        char message[256];
+        snprintf(message, sizeof(message),
+            "Flexible Delay Line: %s %d channels estimated at %.1f MB and %.1fx the CPU of a 1x Linear channel (budget %.1f MB, %.1fx)",
+            bOverBudget ? "over budget," : "back within budget,",
+            FLEXIBLEDELAYLINES_BUDGET_CHANNELS, megabytes, cpu,
+            (float)FLEXIBLEDELAYLINES_MEMORY_BUDGET / (1024.0f * 1024.0f), FLEXIBLEDELAYLINES_CPU_BUDGET);
+        m_linkBack.PostMonitorMessage(message, bOverBudget ? AK::Wwise::Plugin::Severity_Warning : AK::Wwise::Plugin::Severity_Message);
+    }
+    m_bOverBudget = bOverBudget;
+}
+
 bool FlexibleDelayLinesPlugin::GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const
 {
     // Write bank data here
@@ -42,10 +241,31 @@ bool FlexibleDelayLinesPlugin::GetBankParameters(const GUID & in_guidPlatform, A
     in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "WetDryMix"));
     in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Feedback"));
     in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "Distance"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "DelaySpread"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "DampingLowpass"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "DampingHighpass"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "ReferenceDistance"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "JumpThreshold"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CrossfadeTime"));
     
     in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "InterpolationType"));
     in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "OversamplingFactor"));
     in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "UpsamplingMethod"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "StorageFormat"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "DelayMemoryMode"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "DecimationFactor"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "FilterPhase"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "DistanceSource"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "ListenerIndex"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "FeedbackMatrix"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "DCBlocker"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "DistanceEffects"));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "VirtualSnapshot"));
+    in_dataWriter.WriteUInt32(GetMaxDelayTime(in_guidPlatform));
+    in_dataWriter.WriteUInt32(m_propertySet.GetUInt32(in_guidPlatform, "BandSplitCrossover"));
+
+    const FlexibleDelayLinesNonRTPCParams params = GetNonRTPCParams(in_guidPlatform);
+    WriteFilterTables(ResolveEffectiveSettings(params, ESTIMATE_SAMPLE_RATE), params.filterPhase, in_dataWriter);
 
     return true;
 }
@@ -28,19 +28,40 @@ the specific language governing permissions and limitations under the License.
 
 #include <AK/Wwise/Plugin.h>
 
+struct FlexibleDelayLinesCostEstimate;
+struct FlexibleDelayLinesNonRTPCParams;
+
 /// See https://www.audiokinetic.com/library/edge/?source=SDK&id=plugin__dll.html
 /// for the documentation about Authoring plug-ins
 class FlexibleDelayLinesPlugin final
     : public AK::Wwise::Plugin::AudioPlugin
+    , public AK::Wwise::Plugin::RequestLinkBack
+    , public AK::Wwise::Plugin::Notifications::PropertySet_
 {
 public:
     FlexibleDelayLinesPlugin();
     ~FlexibleDelayLinesPlugin();
 
+    /// Estimated delay memory and CPU of one channel with the current properties,
+    /// from the cost model the sound engine plug-in allocates with.
+    FlexibleDelayLinesCostEstimate EstimateCost(const GUID & in_guidPlatform) const;
+
+    /// Warns in the Capture Log when a property change takes the ShareSet over budget.
+    void NotifyPropertyChanged(const GUID & in_guidPlatform, const char * in_szPropertyName) override;
+
     /// This function is called by Wwise to obtain parameters that will be written to a bank.
     /// Because these can be changed at run-time, the parameter block should stay relatively small.
     // Larger data should be put in the Data Block.
+    // The baked filter tables follow the parameters; they add at most about 2 KB.
     bool GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const override;
+
+private:
+    FlexibleDelayLinesNonRTPCParams GetNonRTPCParams(const GUID & in_guidPlatform) const;
+
+    /// Max Delay Time in ms, or when left at 0, the delay the other properties hold the instance at.
+    AkUInt32 GetMaxDelayTime(const GUID & in_guidPlatform) const;
+
+    bool m_bOverBudget;
 };
 
 AK_DECLARE_PLUGIN_CONTAINER(FlexibleDelayLines);	// Exposes our PluginContainer structure that contains the info for our plugin